@@ -1,6 +1,7 @@
 #include "Adafruit_TinyUSB.h"
 #include "neopixel.h"
 #include "report.h"
+#include "hardware/sync.h"
 
 // status led
 #define STATUS_LED 26
@@ -8,33 +9,83 @@
 // data size of rgb
 const int DATA_SIZE = 1284;
 
+// how the strips are driven
+#define OUTPUT_SERIAL 0    // one state machine, one strip after another
+#define OUTPUT_MULTI_SM 1  // a state machine per strip or group of strips, the groups run at once
+#define OUTPUT_PARALLEL 2  // the ws2812_parallel program clocks all strips at once from bit-planes
+// parallel output needs TapeLedPin to be consecutive, otherwise it falls back to multi_sm
+// multi_sm spreads the strips over the state machines that are free, with only one it is serial
+#define OUTPUT_MODE OUTPUT_PARALLEL
+
+// 1 = DMA feeds the strips while loop() keeps running, 0 = loop() waits until a frame is out
+#define DMA_OUTPUT 1
+
 /* RGB */
 // see readme.txt for detail
 const int TapeLedDataOffset[10] = { 0, 222, 258, 294, 462, 630, 912, 948, 984, 1026 };
 const int TapeLedNum[10] = { 74, 12, 12, 56, 56, 94, 12, 12, 14, 86 };
 const int TapeLedPin[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+const int MAX_STRIP_LEDS = 94;
 
 uint8_t brightness = 255;
-uint8_t rgb_data[DATA_SIZE];
 unsigned long last_time_receive;
 
+/* parallel output */
+// 24 bit-planes per LED, word n of an LED holds bit 23-n of every strip's GRB color
+bool parallel_output = false;
+uint32_t planes[MAX_STRIP_LEDS * 24];
+int plane_size;
+
+/* serial and multi_sm output */
+// every strip's colors back to back, strip i starts at TapeLedDataOffset[i] / 3
+uint32_t pixels[DATA_SIZE / 3];
+
+/* output */
+bool dma_output = false;
+// the strips each state machine sends, in order (parallel output: one group sent as one)
+int output_count = 0;
+int group_strips[NEOPIXEL_MAX_OUTPUTS][10];
+int group_size[NEOPIXEL_MAX_OUTPUTS];
+int group_next[NEOPIXEL_MAX_OUTPUTS];  // next one to start for the frame being output
+bool output_active = false;
+// CPU time spent on the frame being output
+uint32_t output_busy_us;
+// when the frame being output arrived over USB, until its first pixel goes out
+uint32_t output_received_us;
+bool output_latency_pending = false;
+
+/* frames */
+// triple buffer: core 0 writes the packets in place into the receive frame and swaps a complete
+// one into ready, core 1 swaps ready with the frame it displays. The frames never move, only the
+// indices are exchanged under a hardware spinlock, so a frame is never written while it is shown
+// and the newest complete frame always wins.
+uint8_t frames[3][DATA_SIZE];
+uint32_t frame_received_us[3];   // when each frame's last packet arrived
+int receive_index = 0;           // core 0
+int display_index = 1;           // core 1
+int ready_index = 2;             // under frame_lock
+bool ready_fresh = false;        // under frame_lock, the ready frame has not been displayed
+// claimed at the top of setup(), setup1() waits for it: core 1 may start before setup() runs
+spin_lock_t *volatile frame_lock;
+
+/* cores */
+// core 0 services USB and the watchdog, core 1 renders
+volatile uint32_t render_heartbeat;  // counted up by core 1, core 0 feeds the watchdog on it
+uint32_t last_heartbeat;
+bool stats_read;                     // under frame_lock, core 1 restarts the maxima when core 0 has sent them
+device_stats stats;                  // under frame_lock, so a report is never half updated
+
 /* USB */
 // desc report, desc len, protocol, interval, use out endpoint
 Adafruit_USBD_HID usb_hid(desc_hid_report, sizeof(desc_hid_report), HID_ITF_PROTOCOL_NONE, 2, true);
-uint8_t usb_buffer[DATA_SIZE];
-// data transfer complete flag
-int transfer_cplt_flag = 0;
 
 void setup() {
+  frame_lock = spin_lock_init(spin_lock_claim_unused(true));
+
   // begin watchdog
-  // reset after 100ms
-  pinMode(STATUS_LED, OUTPUT);
+  // reset after 1s
   rp2040.wdt_begin(1000);
 
-  // init pio state machine for RGB and turn off all strips
-  neopixel_init(TapeLedPin[0]);
-  turn_off_all_strips();
-
   // start HID
   #if defined(ARDUINO_ARCH_MBED) && defined(ARDUINO_ARCH_RP2040)
     TinyUSB_Device_Init(0);
@@ -51,64 +102,285 @@ void setup() {
 }
 
 void loop() {
-  // reset watchdog
-  rp2040.wdt_reset();
+  // reset watchdog while core 1 is rendering, so a hang on either core resets the device
+  uint32_t heartbeat = render_heartbeat;
+  if (heartbeat != last_heartbeat)
+  {
+    last_heartbeat = heartbeat;
+    rp2040.wdt_reset();
+  }
+}
+
+void setup1() {
+  while (frame_lock == NULL) tight_loop_contents();
+  pinMode(STATUS_LED, OUTPUT);
 
-  // turn off all strips if we are not receiving data
-  if (millis()-last_time_receive > 500)
+  // init pio state machines for RGB and turn off all strips
+  #if OUTPUT_MODE == OUTPUT_PARALLEL
+    parallel_output = pins_consecutive() && neopixel_parallel_init(TapeLedPin[0], 10) >= 0;
+  #endif
+  if (parallel_output)
   {
-    turn_off_all_strips();
-    digitalWrite(STATUS_LED,LOW);
+    output_count = 1;
+    group_size[0] = 1;
   }
   else
   {
-    digitalWrite(STATUS_LED,HIGH);
+    assign_strips(OUTPUT_MODE == OUTPUT_SERIAL ? 1 : NEOPIXEL_MAX_OUTPUTS);
   }
+  #if DMA_OUTPUT
+    dma_output = neopixel_dma_init() == 0;
+  #endif
+  uint32_t save = spin_lock_blocking(frame_lock);
+  stats.version = DEVICE_STATS_VERSION;
+  stats.flags = (parallel_output ? DEVICE_STATS_PARALLEL : 0) | (dma_output ? DEVICE_STATS_DMA : 0);
+  stats.outputs = output_count;
+  spin_unlock(frame_lock, save);
+  start_frame(NULL, 0);
+  while (!output_idle()) service_output();
+}
 
-  // if we received one frame, show it
-  if (transfer_cplt_flag) {
+void loop1() {
+  render_heartbeat++;
+
+  // start the next strips when the previous ones are out
+  service_output();
+
+  bool receiving = millis()-last_time_receive <= 500;
+  digitalWrite(STATUS_LED, receiving ? HIGH : LOW);
+
+  // the buffers are being sent until the frame is out
+  if (!output_idle()) return;
+
+  // if we received frames, show the newest, turn off all strips if we are not receiving data
+  if (take_frame()) {
     last_time_receive = millis();
-    transfer_cplt_flag = 0;
+    start_frame(frames[display_index], frame_received_us[display_index]);
+  }
+  else if (!receiving)
+  {
+    start_frame(NULL, 0);
+  }
+}
+
+// core 1: swap in the newest complete frame, returns false when there is none
+bool take_frame()
+{
+  uint32_t save = spin_lock_blocking(frame_lock);
+  bool fresh = ready_fresh;
+  if (fresh)
+  {
+    int ready = ready_index;
+    ready_index = display_index;
+    display_index = ready;
+    ready_fresh = false;
+  }
+  spin_unlock(frame_lock, save);
+  return fresh;
+}
+
+// core 0: publish the received frame, replacing a ready one that was not displayed
+void publish_frame()
+{
+  frame_received_us[receive_index] = time_us_32();
+  uint32_t save = spin_lock_blocking(frame_lock);
+  int ready = ready_index;
+  ready_index = receive_index;
+  ready_fresh = true;
+  spin_unlock(frame_lock, save);
+  receive_index = ready;
+}
+
+bool output_idle()
+{
+  if (output_active) return false;
+  for (int o = 0; o < output_count; o++)
+  {
+    if (neopixel_busy(o)) return false;
+  }
+  return true;
+}
+
+// claim up to max state machines and spread the strips over them, longest first onto the one
+// with the least to send, so the groups take about the same time
+void assign_strips(int max)
+{
+  while (output_count < max && neopixel_init(TapeLedPin[output_count]) >= 0) output_count++;
+
+  int load[NEOPIXEL_MAX_OUTPUTS] = { 0 };
+  bool placed[10] = { false };
+  for (int n = 0; n < 10 && output_count > 0; n++)
+  {
+    int s = -1;
     for (int i = 0; i < 10; i++)
     {
-      uint8_t *pbase = rgb_data + TapeLedDataOffset[i];
-      uint32_t buf[100];
-      for (int j = 0; j < TapeLedNum[i]; j++)
-      {
-        buf[j] = urgb_u32(pbase[3 * j], pbase[3 * j + 1], pbase[3 * j + 2], brightness);
-      }
-      delayMicroseconds(300);
-      neopixel_set_pin(TapeLedPin[i]);
-      neopixel_set_pixels(buf, TapeLedNum[i]);
+      if (!placed[i] && (s < 0 || TapeLedNum[i] > TapeLedNum[s])) s = i;
+    }
+    int o = 0;
+    for (int k = 1; k < output_count; k++)
+    {
+      if (load[k] < load[o]) o = k;
     }
+    placed[s] = true;
+    // switching strips waits for the FIFO to drain, about as long as 10 LEDs
+    load[o] += TapeLedNum[s] + 10;
+    group_strips[o][group_size[o]++] = s;
+  }
+}
+
+// prepare a frame (NULL = black) and start putting it out, the previous one must be done
+// with DMA output this returns at once and loop1() starts the strips, otherwise it blocks
+void start_frame(const uint8_t *data, uint32_t received_us)
+{
+  uint32_t begin = time_us_32();
+  if (parallel_output) plane_size = build_planes(data);
+  else build_pixels(data);
+  for (int o = 0; o < output_count; o++) group_next[o] = 0;
+  output_active = true;
+  output_received_us = received_us;
+  output_latency_pending = data != NULL;
+  output_busy_us = time_us_32() - begin;
+
+  if (!dma_output)
+  {
+    while (output_active) service_output();
+  }
+}
+
+// a state machine may start its next strip once the previous one is out, and the first strip
+// of a frame once the previous frame has latched
+bool output_ready(int o)
+{
+  return group_next[o] == 0 ? neopixel_latched(o) : !neopixel_busy(o);
+}
+
+// start every state machine's next strip that is ready
+void service_output()
+{
+  if (!output_active) return;
+  uint32_t begin = time_us_32();
+  bool started = false;
+  bool done = true;
+  for (int o = 0; o < output_count; o++)
+  {
+    if (group_next[o] == group_size[o]) continue;
+    if (!dma_output) while (!output_ready(o));  // blocking output waits here
+    if (output_ready(o))
+    {
+      if (output_latency_pending) record_latency(time_us_32() - output_received_us);
+      output_latency_pending = false;
+      send_strip(o, group_strips[o][group_next[o]++]);
+      started = true;
+    }
+    if (group_next[o] < group_size[o]) done = false;
+  }
+  if (started) output_busy_us += time_us_32() - begin;
+
+  if (done)
+  {
+    output_active = false;
+    uint32_t save = spin_lock_blocking(frame_lock);
+    if (stats_read)
+    {
+      stats_read = false;
+      stats.busy_max_us = 0;
+      stats.latency_max_us = 0;
+    }
+    stats.frames++;
+    stats.busy_us = output_busy_us;
+    stats.busy_sum_us += output_busy_us;
+    if (output_busy_us > stats.busy_max_us) stats.busy_max_us = output_busy_us;
+    spin_unlock(frame_lock, save);
+  }
+}
+
+// USB receive to first pixel of a frame
+void record_latency(uint32_t latency_us)
+{
+  uint32_t save = spin_lock_blocking(frame_lock);
+  stats.received++;
+  stats.latency_us = latency_us;
+  stats.latency_sum_us += latency_us;
+  if (latency_us > stats.latency_max_us) stats.latency_max_us = latency_us;
+  spin_unlock(frame_lock, save);
+}
+
+void send_strip(int o, int i)
+{
+  if (parallel_output)
+  {
+    neopixel_set_pixels(o, planes, plane_size);
+    return;
+  }
+  neopixel_set_pin(o, TapeLedPin[i]);
+  neopixel_set_pixels(o, pixels + TapeLedDataOffset[i] / 3, TapeLedNum[i]);
+}
+
+// the colors of every strip for serial and multi_sm output
+void build_pixels(const uint8_t *data)
+{
+  for (int j = 0; j < DATA_SIZE / 3; j++)
+  {
+    // the state machine shifts out the top 24 bits
+    pixels[j] = data == NULL ? 0 : urgb_u32(data[3 * j], data[3 * j + 1], data[3 * j + 2], brightness) << 8;
   }
 }
 
-void turn_off_all_strips()
+bool pins_consecutive()
 {
+  for (int i = 1; i < 10; i++)
+  {
+    if (TapeLedPin[i] != TapeLedPin[0] + i) return false;
+  }
+  return true;
+}
+
+// transpose a frame into bit-planes, strips shorter than the longest are padded with black
+// returns the number of words to send
+int build_planes(const uint8_t *data)
+{
+  int longest = 0;
   for (int i = 0; i < 10; i++)
   {
-    uint32_t buf[100];
+    if (TapeLedNum[i] > longest) longest = TapeLedNum[i];
+  }
+  memset(planes, 0, sizeof(uint32_t) * 24 * longest);
+  if (data == NULL) return 24 * longest;
+
+  for (int i = 0; i < 10; i++)
+  {
+    const uint8_t *pbase = data + TapeLedDataOffset[i];
+    uint32_t mask = 1u << (TapeLedPin[i] - TapeLedPin[0]);
     for (int j = 0; j < TapeLedNum[i]; j++)
     {
-      buf[j] = 0;
+      uint32_t grb = urgb_u32(pbase[3 * j], pbase[3 * j + 1], pbase[3 * j + 2], brightness);
+      uint32_t *p = planes + 24 * j;
+      for (int b = 0; b < 24; b++)
+      {
+        // all ones when the bit is set
+        p[b] |= (0u - ((grb >> (23 - b)) & 1u)) & mask;
+      }
     }
-    delayMicroseconds(300);
-    neopixel_set_pin(TapeLedPin[i]);
-    neopixel_set_pixels(buf, TapeLedNum[i]);
   }
+  return 24 * longest;
 }
 
 // Invoked when received GET_REPORT control request
 // Application must fill buffer report's content and return its length.
 // Return zero will cause the stack to STALL request
 uint16_t get_report_callback(uint8_t report_id, hid_report_type_t report_type, uint8_t* buffer, uint16_t reqlen) {
-  // not used in this example
+  // device status, see report.h
   (void)report_id;
   (void)report_type;
-  (void)buffer;
-  (void)reqlen;
-  return 0;
+  // snapshot under the lock core 1 updates it under
+  device_stats snapshot;
+  uint32_t save = spin_lock_blocking(frame_lock);
+  snapshot = stats;
+  stats_read = true;
+  spin_unlock(frame_lock, save);
+  memset(buffer, 0, reqlen);
+  memcpy(buffer, &snapshot, reqlen < sizeof(snapshot) ? reqlen : sizeof(snapshot));
+  return reqlen;
 }
 
 // Invoked when received SET_REPORT control request or
@@ -117,11 +389,11 @@ void set_report_callback(uint8_t report_id, hid_report_type_t report_type, uint8
   // This example doesn't use multiple report and report ID
   (void)report_id;
   (void)report_type;
-  if (buffer[0] != 20) {
-    memcpy(usb_buffer + buffer[0] * 63, buffer + 1, 63);
-  } else {
-    memcpy(usb_buffer + buffer[0] * 63, buffer + 1, 24);
-    memcpy(rgb_data, usb_buffer, DATA_SIZE);
-    transfer_cplt_flag = 1;
+  uint8_t *frame = frames[receive_index];
+  if (buffer[0] < 20) {
+    memcpy(frame + buffer[0] * 63, buffer + 1, 63);
+  } else if (buffer[0] == 20) {
+    memcpy(frame + buffer[0] * 63, buffer + 1, 24);
+    publish_frame();
   }
 }
\ No newline at end of file
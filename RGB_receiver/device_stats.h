@@ -0,0 +1,27 @@
+#pragma once
+// Device status the firmware returns for GET_REPORT, little endian. Shared by the firmware
+// (RGB_receiver.ino through report.h) and hid_send, which reads it after the report byte.
+#include <stdint.h>
+
+#define DEVICE_STATS_VERSION 2
+#define DEVICE_STATS_PARALLEL 0x01  // flags: strips are clocked at once
+#define DEVICE_STATS_DMA 0x02       // flags: DMA feeds the strips
+
+struct device_stats {
+  uint8_t version;
+  uint8_t flags;
+  uint8_t outputs;        // state machines driving the strips
+  uint8_t reserved;
+  uint32_t frames;       // frames put out, blank ones included
+  uint32_t busy_us;      // CPU time the last frame's output took
+  uint32_t busy_sum_us;  // running sum of busy_us, wraps
+  uint32_t busy_max_us;  // largest busy_us since the last GET_REPORT
+  // version 2, zero before
+  uint32_t received;        // frames from USB put out
+  uint32_t latency_us;      // USB receive to first pixel of the last one
+  uint32_t latency_sum_us;  // running sum of latency_us, wraps
+  uint32_t latency_max_us;  // largest latency_us since the last GET_REPORT
+};
+
+// must fit the 64-byte input report; fields are only ever appended
+static_assert(sizeof(device_stats) == 36, "device_stats layout changed");
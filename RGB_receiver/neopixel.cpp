@@ -1,47 +1,167 @@
 #include "ws2812.pio.h"
 #include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include <Arduino.h>
+#include "neopixel.h"
 
 #define IS_RGBW false
 
-PIO pio = pio0;
-int sm = 0;
-int running = false;
-int init_pin;
+// the line rests this long after the last bit so the strips latch
+#define LATCH_US 300
+// words still going out when the last one is queued: a full joined FIFO plus the shift register
+#define WORDS_IN_FLIGHT 9
+
+// a claimed state machine and the DMA channel feeding it
+struct neopixel_output {
+  PIO pio;
+  int sm;
+  int dma;                         // -1 = blocking puts
+  uint32_t drain_us;               // time the words in flight take
+  volatile bool dma_busy;
+  volatile uint32_t last_word_us;  // when the last word of the previous send was queued
+};
+
+// file scope only: the sketch has its own globals (its output_count counts strip groups)
+static neopixel_output outputs[NEOPIXEL_MAX_OUTPUTS];
+static int neopixel_sm_count = 0;  // state machines claimed, the valid output numbers
+// offset of each program on pio0 and pio1, -1 = not loaded
+static int ws2812_offset[2] = { -1, -1 };
+static int ws2812_parallel_offset[2] = { -1, -1 };
+static int dma_irq_installed = false;
+
+// claim a free state machine on a PIO that has, or has room for, the program
+static int claim_sm(const pio_program_t* program, int* offsets, PIO* pio, int* sm, uint* offset)
+{
+  if (neopixel_sm_count >= NEOPIXEL_MAX_OUTPUTS) return -1;
+  for (int i = 0; i < 2; i++) {
+    PIO p = i == 0 ? pio0 : pio1;
+    if (offsets[i] < 0 && !pio_can_add_program(p, program)) continue;
+    int s = pio_claim_unused_sm(p, false);  // Find a free SM
+    if (s < 0) continue;  // Try pio1 if SM not found
+    if (offsets[i] < 0) offsets[i] = pio_add_program(p, program);
+    *pio = p;
+    *sm = s;
+    *offset = offsets[i];
+    return 0;
+  }
+  return -1;  // Return error if SM not found
+}
+
+static int add_output(PIO pio, int sm, uint32_t drain_us)
+{
+  neopixel_output& o = outputs[neopixel_sm_count];
+  o.pio = pio;
+  o.sm = sm;
+  o.dma = -1;
+  o.drain_us = drain_us;
+  o.dma_busy = false;
+  o.last_word_us = time_us_32();
+  return neopixel_sm_count++;
+}
 
 int neopixel_init(int pin)
 {
-  if (running) return 0;
-  init_pin = pin;
-  sm = pio_claim_unused_sm(pio, false);  // Find a free SM
-  if (sm < 0) {
-    pio = pio1;  // Try pio1 if SM not found
-    sm = pio_claim_unused_sm(pio, false);
+  PIO pio;
+  int sm;
+  uint offset;
+  if (claim_sm(&ws2812_program, ws2812_offset, &pio, &sm, &offset) < 0) return -1;
+  ws2812_program_init(pio, sm, offset, pin, 800000, IS_RGBW);
+  return add_output(pio, sm, WORDS_IN_FLIGHT * 30);  // a pixel per word, 30us each
+}
+
+int neopixel_parallel_init(int pin_base, int pin_count)
+{
+  PIO pio;
+  int sm;
+  uint offset;
+  if (claim_sm(&ws2812_parallel_program, ws2812_parallel_offset, &pio, &sm, &offset) < 0) return -1;
+  ws2812_parallel_program_init(pio, sm, offset, pin_base, pin_count, 800000);
+  return add_output(pio, sm, WORDS_IN_FLIGHT * 2);  // a bit per word, 1.25us each
+}
+
+void neopixel_set_pin(int out, int pin)
+{
+  if (out < 0 || out >= neopixel_sm_count) return;
+  neopixel_output& o = outputs[out];
+  pio_gpio_init(o.pio, pin);
+  pio_sm_set_consecutive_pindirs(o.pio, o.sm, pin, 1, true);
+  pio_sm_set_sideset_pins(o.pio, o.sm, pin);
+}
+
+static void dma_complete_handler()
+{
+  for (int i = 0; i < neopixel_sm_count; i++) {
+    neopixel_output& o = outputs[i];
+    if (o.dma < 0 || !dma_channel_get_irq0_status(o.dma)) continue;
+    dma_channel_acknowledge_irq0(o.dma);
+    o.last_word_us = time_us_32();
+    o.dma_busy = false;
+  }
+}
+
+int neopixel_dma_init()
+{
+  for (int i = 0; i < neopixel_sm_count; i++) {
+    if (outputs[i].dma >= 0) continue;
+    int channel = dma_claim_unused_channel(false);
+    if (channel < 0) {
+      // Return error if a channel is missing, every output stays blocking
+      for (int j = 0; j < i; j++) {
+        dma_channel_set_irq0_enabled(outputs[j].dma, false);
+        dma_channel_unclaim(outputs[j].dma);
+        outputs[j].dma = -1;
+      }
+      return -1;
+    }
+    outputs[i].dma = channel;
+    dma_channel_set_irq0_enabled(channel, true);
+  }
+  if (!dma_irq_installed) {
+    irq_add_shared_handler(DMA_IRQ_0, dma_complete_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    dma_irq_installed = true;
   }
-  if (sm < 0) return -1;  // Return error if SM not found
-  uint offset = pio_add_program(pio, &ws2812_program);
-  ws2812_program_init(pio, sm, offset, init_pin, 800000, IS_RGBW);
-  running = true;
   return 0;
 }
 
-void neopixel_set_pin(int pin)
+// true while words of the previous send are going out: a buffer being sent through DMA must
+// stay untouched and the pin may only change after it
+bool neopixel_busy(int out)
 {
-  if (!running) return;
-  pio_gpio_init(pio, pin);
-  pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, true);
-  pio_sm_set_sideset_pins(pio, sm, pin);
+  if (out < 0 || out >= neopixel_sm_count) return false;
+  neopixel_output& o = outputs[out];
+  return o.dma_busy || time_us_32() - o.last_word_us < o.drain_us;
 }
 
-static void put_pixel(uint32_t pixel_grb) {
-  pio_sm_put_blocking(pio, sm, pixel_grb << 8u);
+// true once the previous send is out and the line has rested long enough for the strips to latch
+bool neopixel_latched(int out)
+{
+  if (out < 0 || out >= neopixel_sm_count) return true;
+  neopixel_output& o = outputs[out];
+  return !o.dma_busy && time_us_32() - o.last_word_us >= o.drain_us + LATCH_US;
 }
 
-void neopixel_set_pixels(uint32_t* buf, int size)
+// words as the output's program takes them: colors from urgb_u32 << 8 for a strip (the state
+// machine shifts out the top 24 bits), bit-planes for parallel output (bit n drives pin_base + n).
+// Sent through DMA when the output has a channel, blocking otherwise.
+void neopixel_set_pixels(int out, const uint32_t* words, int size)
 {
-  if (!running) return;
+  if (out < 0 || out >= neopixel_sm_count) return;
+  neopixel_output& o = outputs[out];
+  if (o.dma >= 0) {
+    dma_channel_config c = dma_channel_get_default_config(o.dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(o.pio, o.sm, true));
+    o.dma_busy = true;
+    dma_channel_configure(o.dma, &c, &o.pio->txf[o.sm], words, size, true);
+    return;
+  }
   for (int i = 0; i < size; i++)
-    put_pixel(buf[i]);
+    pio_sm_put_blocking(o.pio, o.sm, words[i]);
+  o.last_word_us = time_us_32();
 }
 
 uint32_t urgb_u32(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
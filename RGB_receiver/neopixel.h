@@ -1,4 +1,12 @@
+// up to 4 state machines on each of pio0 and pio1
+#define NEOPIXEL_MAX_OUTPUTS 8
+
+// each init claims a state machine and returns its output number, -1 when none is free
 int neopixel_init(int pin);
-void neopixel_set_pin(int pin);
-void neopixel_set_pixels(uint32_t* buf, int size);
+int neopixel_parallel_init(int pin_base, int pin_count);
+int neopixel_dma_init();
+bool neopixel_busy(int out);
+bool neopixel_latched(int out);
+void neopixel_set_pin(int out, int pin);
+void neopixel_set_pixels(int out, const uint32_t* words, int size);
 uint32_t urgb_u32(uint8_t r, uint8_t g, uint8_t b, uint8_t w);
\ No newline at end of file
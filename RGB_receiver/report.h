@@ -1,3 +1,6 @@
+// device status, returned for GET_REPORT
+#include "device_stats.h"
+
 // RawHID might never work with multireports, because of OS problems
 // therefore we have to make it a single report with no ID. No other HID device will be supported then.
 #undef RAWHID_USAGE_PAGE
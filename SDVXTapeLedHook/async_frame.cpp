@@ -0,0 +1,41 @@
+#include "async_frame.h"
+#include "config.h"
+#include <algorithm>
+#include <cstring>
+
+// Hand the frame being assembled to the worker, or drop it if it had to go to spill
+static void CommitFrame(AsyncFrameQueue& queue, AsyncProducer& producer, const TimeSource& time) {
+    if (producer.frame == &producer.spill) {
+        producer.dropped++;
+    } else {
+        producer.frame->time = ReadTime(time);
+        queue.CommitPush();
+        producer.queued++;
+        producer.maxDepth = std::max(producer.maxDepth, queue.Size());
+    }
+    producer.frame = nullptr;
+}
+
+bool PushAsyncStrip(AsyncFrameQueue& queue, AsyncProducer& producer, int index, const uint8_t* data,
+                    const TimeSource& time) {
+    uint16_t bit = static_cast<uint16_t>(1 << index);
+    uint64_t queuedBefore = producer.queued;
+
+    if (producer.frame && (producer.frame->strips & bit))
+        CommitFrame(queue, producer, time);
+
+    // A new frame takes the next free slot, if the worker has left one
+    if (!producer.frame) {
+        AsyncFrame* slot = queue.BeginPush();
+        producer.frame = slot ? slot : &producer.spill;
+        producer.frame->strips = 0;
+    }
+
+    AsyncFrame& frame = *producer.frame;
+    memcpy(frame.rgb + StripByteOffset[index], data, StripLedCount[index] * 3);
+    frame.strips |= bit;
+
+    if (frame.strips == ALL_STRIPS)
+        CommitFrame(queue, producer, time);
+    return producer.queued != queuedBefore;
+}
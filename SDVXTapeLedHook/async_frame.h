@@ -0,0 +1,34 @@
+#pragma once
+#include "frame.h"
+#include "spsc_queue.h"
+
+// Asynchronous transform: the game thread only copies the raw strips into a queue and returns;
+// a worker thread transforms and publishes the frames. Frames are assembled in place in the
+// queue slot, so the game thread pays one copy per strip.
+
+// Frames the worker may fall behind before new ones are dropped (power of two)
+static constexpr uint32_t ASYNC_QUEUE_DEPTH = 8;
+
+struct AsyncFrame {
+    uint8_t rgb[FRAME_BYTES];   // raw strips as the game sent them
+    uint16_t strips;            // bit i = strip i present
+    double time;                // time source reading when the frame was completed
+};
+
+typedef SpscQueue<AsyncFrame, ASYNC_QUEUE_DEPTH> AsyncFrameQueue;
+
+// Game-thread side of the queue
+struct AsyncProducer {
+    AsyncFrame* frame;          // frame being assembled: a queue slot, or spill
+    AsyncFrame spill;           // used while the queue is full; its frames are dropped
+    uint64_t queued;            // frames committed to the queue
+    uint64_t dropped;           // frames dropped because the worker was a whole queue behind
+    uint32_t maxDepth;          // deepest the queue has been after a commit
+};
+
+// Copy strip index into the frame being assembled. The frame is committed once every strip is
+// present, or when a strip arrives again (the partial frame is committed first, as the
+// synchronous hook flushes it). time is only read on commit. Returns true if a frame was
+// committed, i.e. the worker has something new.
+bool PushAsyncStrip(AsyncFrameQueue& queue, AsyncProducer& producer, int index, const uint8_t* data,
+                    const TimeSource& time);
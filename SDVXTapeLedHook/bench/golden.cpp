@@ -0,0 +1,396 @@
+// Golden-output regression check for the transform path.
+//
+// Replays a frame set through TransformFrame (beat detection, transform, pulses, fade) for
+// every INI in a corpus directory (SDVXTapeLedHook/golden/) and compares the output against
+// the reference path: scalar SIMD level, generic plan interpreter (RunPlan), no 3D LUT.
+// The fast path is checked at every SIMD level this CPU supports.
+//
+// The reference path is itself pinned across commits by <corpus_dir>/reference.hashes, a
+// committed 64-bit FNV-1a hash of each config's reference output over the synthetic frames.
+// check compares against it by default, so a change that moves the reference and the fast
+// path together still fails. After an intended output change, rerun hash and commit the
+// file. Full goldens can also be stored: record them on a known-good checkout, then check a
+// later one against the file.
+//
+//   golden hash   <corpus_dir> [out.hashes]  [--capture file.sdvxcap]
+//   golden record <corpus_dir> <out.golden> [--capture file.sdvxcap]
+//   golden check  <corpus_dir> [goldens]    [--capture file.sdvxcap] [--exact]
+//
+// Without --capture a deterministic synthetic frame set is used (random, sparse, ramps,
+// beats, on/off blocks). Each INI may set its allowed max channel error in a [golden]
+// section (tolerance=N, default 0); --exact requires bit-exact output everywhere.
+//
+// Built by the CMake project in SDVXTapeLedHook/ as golden.
+#include "ini_file.h"
+#include "frame.h"
+#include "transform_simd.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr int SYNTHETIC_FRAMES = 600;
+static const char GOLDEN_MAGIC[8] = { 'S', 'D', 'V', 'X', 'G', 'L', 'D', '1' };
+static const char REFERENCE_HASHES[] = "reference.hashes";
+
+struct Frame {
+    double timestamp;
+    uint8_t data[FRAME_BYTES];
+};
+
+struct Config {
+    std::string name;       // file name without extension
+    IniFile ini;
+    int tolerance;
+};
+
+static bool LoadCapture(const char* path, std::vector<Frame>& frames) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    Frame frame;
+    while (fread(&frame.timestamp, 8, 1, f) == 1 && fread(frame.data, FRAME_BYTES, 1, f) == 1)
+        frames.push_back(frame);
+    fclose(f);
+    return true;
+}
+
+// 60 fps, switching pattern every second
+static void MakeSyntheticFrames(std::vector<Frame>& frames) {
+    std::mt19937 rng(20240607);
+    frames.resize(SYNTHETIC_FRAMES);
+    for (int f = 0; f < SYNTHETIC_FRAMES; f++) {
+        Frame& frame = frames[f];
+        frame.timestamp = f / 60.0;
+        for (int led = 0; led < FRAME_BYTES / 3; led++) {
+            uint8_t* px = frame.data + led * 3;
+            switch ((f / 60) % 5) {
+                case 0:  // random full range
+                    for (int c = 0; c < 3; c++)
+                        px[c] = static_cast<uint8_t>(rng());
+                    break;
+                case 1:  // sparse random colors
+                    for (int c = 0; c < 3; c++)
+                        px[c] = (rng() % 4 == 0) ? static_cast<uint8_t>(rng()) : 0;
+                    break;
+                case 2:  // moving ramps
+                    for (int c = 0; c < 3; c++)
+                        px[c] = static_cast<uint8_t>(led * 7 + f * 3 + c * 85);
+                    break;
+                case 3: {  // beats: a bright flash every 15 frames over a dim base
+                    bool flash = (f % 15) < 3;
+                    px[0] = flash ? 240 : 20;
+                    px[1] = flash ? 200 : static_cast<uint8_t>(rng() % 16);
+                    px[2] = flash ? 255 : 30;
+                    break;
+                }
+                default: {  // blocks switching on and off, for fades
+                    bool on = ((led / 8 + f / 10) % 2) != 0;
+                    px[0] = on ? static_cast<uint8_t>(led * 13) : 0;
+                    px[1] = on ? 0x80 : 0;
+                    px[2] = on ? static_cast<uint8_t>(255 - led) : 0;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static bool LoadCorpus(const char* dir, std::vector<Config>& configs) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.path().extension() == ".ini")
+            paths.push_back(entry.path());
+    }
+    if (ec)
+        return false;
+    std::sort(paths.begin(), paths.end());
+
+    for (const auto& path : paths) {
+        Config config;
+        config.name = path.stem().string();
+        if (!LoadIniFile(config.ini, path.string().c_str()))
+            return false;
+        char buf[16];
+        IniSource source = MakeIniSource(config.ini);
+        source.getString(source.ctx, "golden", "tolerance", "0", buf, sizeof(buf));
+        config.tolerance = atoi(buf);
+        configs.push_back(config);
+    }
+    return !configs.empty();
+}
+
+// Run every frame through one config, writing FRAME_BYTES bytes per frame to out.
+// reference = scalar, generic interpreter, exact color path.
+static void RunConfig(const Config& config, const std::vector<Frame>& frames, bool reference,
+                      SimdLevel level, std::vector<uint8_t>& out) {
+    static StripTransform strips[10];
+    static FrameState state;
+
+    SetSimdLevel(reference ? SIMD_SCALAR : level);
+    ResetStrips(strips);
+    LoadStrips(strips, MakeIniSource(config.ini));
+    if (reference) {
+        for (int i = 0; i < 10; i++) {
+            strips[i].lut_max_error = 0;
+            BuildPlan(strips[i], StripLedCount[i], StripSectionNames[i]);
+            strips[i].kernel = RunPlan;
+        }
+    }
+    memset(&state, 0, sizeof(state));
+
+    // Virtual time: the recorded timestamps, however long the pass takes
+    out.resize(frames.size() * FRAME_BYTES);
+    VirtualClock time = { frames.front().timestamp };
+    TimeSource source = VirtualTimeSource(time);
+    FrameClock clock = StartFrameClock(source);
+    for (size_t f = 0; f < frames.size(); f++) {
+        time.time = frames[f].timestamp;
+        TickFrameClock(clock, source);
+        TransformFrame(strips, state, frames[f].data, out.data() + f * FRAME_BYTES, clock);
+    }
+}
+
+// Compare against the golden output; returns true if within tolerance
+static bool Compare(const Config& config, const char* path, const std::vector<uint8_t>& golden,
+                    const std::vector<uint8_t>& actual, int tolerance) {
+    int maxError = 0;
+    size_t diffs = 0, first = 0;
+    for (size_t i = 0; i < actual.size(); i++) {
+        int err = std::abs(golden[i] - actual[i]);
+        if (err != 0 && diffs++ == 0)
+            first = i;
+        maxError = std::max(maxError, err);
+    }
+
+    bool pass = maxError <= tolerance;
+    printf("%-20s%-10s%6d%8d%10zu", config.name.c_str(), path, tolerance, maxError, diffs);
+    if (diffs > 0) {
+        size_t frame = first / FRAME_BYTES;
+        int offset = static_cast<int>(first % FRAME_BYTES);
+        int strip = 9;
+        while (StripByteOffset[strip] > offset)
+            strip--;
+        printf("   first: frame %zu %s LED %d", frame, StripSectionNames[strip],
+               (offset - StripByteOffset[strip]) / 3);
+    }
+    printf("%s\n", pass ? "" : "   FAIL");
+    return pass;
+}
+
+static bool WriteGoldens(const char* path, const std::vector<Config>& configs,
+                         const std::vector<Frame>& frames) {
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        return false;
+    uint32_t header[2] = { static_cast<uint32_t>(frames.size()), static_cast<uint32_t>(configs.size()) };
+    fwrite(GOLDEN_MAGIC, sizeof(GOLDEN_MAGIC), 1, f);
+    fwrite(header, sizeof(header), 1, f);
+
+    std::vector<uint8_t> out;
+    for (const Config& config : configs) {
+        char name[64] = {};
+        snprintf(name, sizeof(name), "%s", config.name.c_str());
+        RunConfig(config, frames, true, SIMD_SCALAR, out);
+        fwrite(name, sizeof(name), 1, f);
+        fwrite(out.data(), 1, out.size(), f);
+        printf("recorded %s\n", config.name.c_str());
+    }
+    return fclose(f) == 0;
+}
+
+// Find one config's goldens in a golden file; false if it is missing or for other frames
+static bool ReadGolden(const char* path, const Config& config, size_t frameCount,
+                       std::vector<uint8_t>& golden) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    char magic[8];
+    uint32_t header[2];
+    bool found = false;
+    if (fread(magic, sizeof(magic), 1, f) == 1 && memcmp(magic, GOLDEN_MAGIC, sizeof(magic)) == 0 &&
+        fread(header, sizeof(header), 1, f) == 1 && header[0] == frameCount) {
+        golden.resize(frameCount * FRAME_BYTES);
+        for (uint32_t c = 0; c < header[1] && !found; c++) {
+            char name[64];
+            if (fread(name, sizeof(name), 1, f) != 1 || fread(golden.data(), 1, golden.size(), f) != golden.size())
+                break;
+            name[63] = '\0';
+            found = (config.name == name);
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+// 64-bit FNV-1a
+static uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ p[i]) * 1099511628211ull;
+    return hash;
+}
+
+static uint64_t HashFrames(const std::vector<Frame>& frames) {
+    uint64_t hash = Hash(nullptr, 0);
+    for (const Frame& frame : frames) {
+        hash = Hash(&frame.timestamp, sizeof(frame.timestamp), hash);
+        hash = Hash(frame.data, sizeof(frame.data), hash);
+    }
+    return hash;
+}
+
+// Text file: the input frames' count and hash, then one "<config> <hash>" line per config
+static bool WriteHashes(const char* path, const std::vector<Config>& configs,
+                        const std::vector<Frame>& frames) {
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        return false;
+    fprintf(f, "# golden hash: FNV-1a of each config's reference output, for bench/golden.cpp\r\n");
+    fprintf(f, "frames %zu %016llx\r\n", frames.size(),
+            static_cast<unsigned long long>(HashFrames(frames)));
+
+    std::vector<uint8_t> out;
+    for (const Config& config : configs) {
+        RunConfig(config, frames, true, SIMD_SCALAR, out);
+        uint64_t hash = Hash(out.data(), out.size());
+        fprintf(f, "%s %016llx\r\n", config.name.c_str(), static_cast<unsigned long long>(hash));
+        printf("%-20s%016llx\n", config.name.c_str(), static_cast<unsigned long long>(hash));
+    }
+    return fclose(f) == 0;
+}
+
+// Read a hash file; false if it is missing or was made from other frames
+static bool ReadHashes(const char* path, const std::vector<Frame>& frames,
+                       std::map<std::string, uint64_t>& hashes) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    char line[256], name[128];
+    unsigned long long hash;
+    size_t count;
+    bool forFrames = false;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "frames %zu %llx", &count, &hash) == 2)
+            forFrames = (count == frames.size() && hash == HashFrames(frames));
+        else if (sscanf(line, "%127s %llx", name, &hash) == 2)
+            hashes[name] = hash;
+    }
+    fclose(f);
+    return forFrames;
+}
+
+static void Quiet(const char*) {}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || (strcmp(argv[1], "record") != 0 && strcmp(argv[1], "check") != 0 &&
+                     strcmp(argv[1], "hash") != 0)) {
+        fprintf(stderr, "usage: %s hash <corpus_dir> [out.hashes] [--capture file.sdvxcap]\n"
+                        "       %s record <corpus_dir> <out.golden> [--capture file.sdvxcap]\n"
+                        "       %s check <corpus_dir> [goldens] [--capture file.sdvxcap] [--exact]\n",
+                argv[0], argv[0], argv[0]);
+        return 2;
+    }
+    bool record = strcmp(argv[1], "record") == 0;
+    bool hash = strcmp(argv[1], "hash") == 0;
+    const char* corpus = argv[2];
+    const char* goldenPath = nullptr;
+    const char* capture = nullptr;
+    bool exact = false;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            capture = argv[++i];
+        else if (strcmp(argv[i], "--exact") == 0)
+            exact = true;
+        else if (!goldenPath)
+            goldenPath = argv[i];
+    }
+    if (record && !goldenPath) {
+        fprintf(stderr, "record needs an output file\n");
+        return 2;
+    }
+
+    InitSimd();
+    SetTransformLog(Quiet);
+
+    std::vector<Frame> frames;
+    if (capture) {
+        if (!LoadCapture(capture, frames) || frames.empty()) {
+            fprintf(stderr, "cannot read frames from %s\n", capture);
+            return 1;
+        }
+    } else {
+        MakeSyntheticFrames(frames);
+    }
+
+    std::vector<Config> configs;
+    if (!LoadCorpus(corpus, configs)) {
+        fprintf(stderr, "no INI files in %s\n", corpus);
+        return 1;
+    }
+
+    std::string hashPath = (std::filesystem::path(corpus) / REFERENCE_HASHES).string();
+    if (hash)
+        return WriteHashes(goldenPath ? goldenPath : hashPath.c_str(), configs, frames) ? 0 : 1;
+    if (record)
+        return WriteGoldens(goldenPath, configs, frames) ? 0 : 1;
+
+    // Without a golden file the reference path is the golden, and the committed hashes pin it.
+    // They only cover the frames they were made from; the synthetic set must have them.
+    int failures = 0;
+    std::map<std::string, uint64_t> hashes;
+    bool hashed = false;
+    if (!goldenPath) {
+        hashed = ReadHashes(hashPath.c_str(), frames, hashes);
+        if (!hashed && !capture) {
+            printf("%s is missing or for other frames: run golden hash\n", hashPath.c_str());
+            failures++;
+        }
+    }
+
+    SimdLevel best = DetectSimdLevel();
+    printf("%zu frames, %zu configs, goldens from %s%s%s\n\n", frames.size(), configs.size(),
+           goldenPath ? goldenPath : "the reference path", hashed ? ", checked against " : "",
+           hashed ? hashPath.c_str() : "");
+    printf("%-20s%-10s%6s%8s%10s\n", "config", "path", "tol", "maxerr", "diffs");
+
+    std::vector<uint8_t> golden, actual;
+    for (const Config& config : configs) {
+        if (goldenPath) {
+            if (!ReadGolden(goldenPath, config, frames.size(), golden)) {
+                printf("%-20sno golden for these frames\n", config.name.c_str());
+                failures++;
+                continue;
+            }
+        } else {
+            RunConfig(config, frames, true, SIMD_SCALAR, golden);
+            if (hashed) {
+                auto it = hashes.find(config.name);
+                bool match = it != hashes.end() && it->second == Hash(golden.data(), golden.size());
+                printf("%-20s%-10s%s\n", config.name.c_str(), "hash",
+                       match ? "" : (it == hashes.end() ? "   FAIL: not in the hash file"
+                                                        : "   FAIL: reference output changed"));
+                if (!match)
+                    failures++;
+            }
+        }
+
+        int tolerance = exact ? 0 : config.tolerance;
+        for (int level = SIMD_SCALAR; level <= best; level++) {
+            RunConfig(config, frames, false, static_cast<SimdLevel>(level), actual);
+            if (!Compare(config, SimdLevelName(static_cast<SimdLevel>(level)), golden, actual, tolerance))
+                failures++;
+        }
+    }
+
+    printf("\n%s (%d failing)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,397 @@
+// Accuracy and cost benchmark for the frame-level onset detector (onset.h).
+//
+// Replays frames through DetectOnset and, for comparison, through the per-strip detector the
+// hook used before it (each strip's own mean brightness rising by more than 15), and reports
+// per strip the frames on which each would spawn a pulse.
+//
+// Without a capture, a synthetic track with known beat times is generated: sections of
+// different tempo and loudness, beats flashing the woofer and speakers (and the wings less),
+// over moving wing colors, dim title/V unit noise and random lane flashes on the control panel
+// that are not beats. A strip's pulse matches a beat when it fires within ONSET_TOLERANCE frames
+// of it; precision, recall and latency are summed over all strips, since every strip with a
+// pulse color should fire on every beat. With a capture there is no ground truth, so the
+// onset rate and the agreement between the two detectors are reported instead.
+//
+// Cost is the time per frame of each detector over all 10 strips, at every SIMD level this CPU
+// supports (the legacy detector is scalar).
+//
+// Built by the CMake project in SDVXTapeLedHook/ as onset_bench:
+//   onset_bench [capture.sdvxcap] [--ini sdvxrgb.ini] [--passes N]
+#include "ini_file.h"
+#include "config.h"
+#include "frame.h"
+#include "transform_simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static constexpr int CAPTURE_FRAME_SIZE = 8 + FRAME_BYTES;  // double timestamp + RGB data
+static constexpr double SYNTHETIC_FPS = 60.0;
+static constexpr int SYNTHETIC_SECONDS = 120;
+static constexpr int ONSET_TOLERANCE = 2;                   // frames either side of a beat
+static constexpr float LEGACY_BEAT_THRESHOLD = 15.0f;
+
+struct Frame {
+    double timestamp;
+    uint8_t data[FRAME_BYTES];
+};
+
+static bool LoadCapture(const char* path, std::vector<Frame>& frames) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    uint8_t buf[CAPTURE_FRAME_SIZE];
+    while (fread(buf, 1, CAPTURE_FRAME_SIZE, f) == CAPTURE_FRAME_SIZE) {
+        Frame frame;
+        memcpy(&frame.timestamp, buf, 8);
+        memcpy(frame.data, buf + 8, FRAME_BYTES);
+        frames.push_back(frame);
+    }
+    fclose(f);
+    return true;
+}
+
+// --- Synthetic track ---
+
+static void FillStrip(uint8_t* frame, int strip, int r, int g, int b) {
+    uint8_t* p = frame + StripByteOffset[strip];
+    for (int i = 0; i < StripLedCount[strip]; i++) {
+        p[i * 3] = static_cast<uint8_t>(std::min(std::max(r, 0), 255));
+        p[i * 3 + 1] = static_cast<uint8_t>(std::min(std::max(g, 0), 255));
+        p[i * 3 + 2] = static_cast<uint8_t>(std::min(std::max(b, 0), 255));
+    }
+}
+
+// Frames of the synthetic track, and the index of the first frame of each beat
+static void MakeSyntheticTrack(std::vector<Frame>& frames, std::vector<int>& beats) {
+    static const float tempos[] = { 90.0f, 120.0f, 150.0f, 175.0f };
+    static const float levels[] = { 0.35f, 0.6f, 1.0f };
+    static const int speakers[] = { 1, 2, 6, 7, 8 };
+    std::mt19937 rng(20251016);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    int count = static_cast<int>(SYNTHETIC_FPS * SYNTHETIC_SECONDS);
+    frames.resize(count);
+    double nextBeat = 0.5, lastBeat = -10.0;
+    float beatLevel = 0.0f;
+    double nextLane = 0.3, laneUntil = -1.0;
+    int laneStart = 0;
+
+    for (int f = 0; f < count; f++) {
+        double t = f / SYNTHETIC_FPS;
+        int section = static_cast<int>(t / 15.0);
+        float tempo = tempos[section % 4];
+        float level = levels[(section * 7 / 3) % 3];
+
+        Frame& frame = frames[f];
+        frame.timestamp = t + (unit(rng) - 0.5f) * 0.002f;
+        if (t >= nextBeat) {
+            beats.push_back(f);
+            lastBeat = t;
+            beatLevel = level * (0.8f + 0.2f * unit(rng));
+            nextBeat += 60.0 / tempo;
+        }
+
+        // Beat flash decaying over ~80 ms
+        float flash = beatLevel * expf(-static_cast<float>(t - lastBeat) / 0.08f);
+        memset(frame.data, 0, FRAME_BYTES);
+        for (int s : speakers)
+            FillStrip(frame.data, s, static_cast<int>(255 * flash), static_cast<int>(40 * flash), static_cast<int>(200 * flash));
+
+        // Wings: slowly moving colors, lifted a little by the beat
+        float sway = 0.5f + 0.5f * sinf(static_cast<float>(t) * 0.7f);
+        for (int s = 3; s <= 4; s++) {
+            uint8_t* p = frame.data + StripByteOffset[s];
+            for (int i = 0; i < StripLedCount[s]; i++) {
+                float wave = 0.5f + 0.5f * sinf(i * 0.2f + static_cast<float>(t) * 3.0f);
+                p[i * 3] = static_cast<uint8_t>(std::min(40.0f + 60.0f * wave * sway + 80.0f * flash, 255.0f));
+                p[i * 3 + 2] = static_cast<uint8_t>(std::min(80.0f * (1.0f - wave) + 80.0f * flash, 255.0f));
+            }
+        }
+
+        // Title and V unit: dim, noisy
+        for (int s : { 0, 9 }) {
+            uint8_t* p = frame.data + StripByteOffset[s];
+            for (int i = 0; i < StripLedCount[s] * 3; i++)
+                p[i] = static_cast<uint8_t>(20 + rng() % 6);
+        }
+
+        // Control panel: lane flashes at random times, unrelated to the beat
+        if (t >= nextLane) {
+            laneUntil = t + 4.0 / SYNTHETIC_FPS;
+            laneStart = static_cast<int>(rng() % (StripLedCount[5] - 16));
+            nextLane = t - logf(1.0f - unit(rng) * 0.999f) / 3.0f;
+        }
+        if (t < laneUntil) {
+            uint8_t* p = frame.data + StripByteOffset[5] + laneStart * 3;
+            memset(p, 255, 16 * 3);
+        }
+    }
+}
+
+// --- Detectors ---
+
+// The detector the hook used before the frame-level one: per strip, its own mean brightness
+// rising by more than LEGACY_BEAT_THRESHOLD
+struct LegacyDetector {
+    bool seeded;
+    float prev[10];
+};
+
+static uint16_t DetectLegacy(LegacyDetector& det, const uint8_t* in) {
+    uint16_t fired = 0;
+    for (int i = 0; i < 10; i++) {
+        const uint8_t* data = in + StripByteOffset[i];
+        int numBytes = StripLedCount[i] * 3;
+        int sum = 0;
+        for (int j = 0; j < numBytes; j++)
+            sum += data[j];
+        float brightness = static_cast<float>(sum) / static_cast<float>(numBytes);
+        if (det.seeded && brightness - det.prev[i] > LEGACY_BEAT_THRESHOLD)
+            fired |= static_cast<uint16_t>(1 << i);
+        det.prev[i] = brightness;
+    }
+    det.seeded = true;
+    return fired;
+}
+
+// Strips each detector would fire a pulse on, per frame
+static void RunDetectors(const std::vector<Frame>& frames, const StripTransform strips[10],
+                         std::vector<uint16_t>& legacy, std::vector<uint16_t>& shared) {
+    LegacyDetector legacyDet = {};
+    static OnsetDetector det;
+    memset(&det, 0, sizeof(det));
+    FrameClock clock = StartFrameClock(frames.front().timestamp);
+    legacy.clear();
+    shared.clear();
+    for (const Frame& frame : frames) {
+        TickFrameClock(clock, frame.timestamp);
+        legacy.push_back(DetectLegacy(legacyDet, frame.data));
+        const OnsetState& onset = DetectOnset(det, strips, frame.data, ALL_STRIPS, clock);
+        uint16_t fired = 0;
+        for (int i = 0; i < 10; i++) {
+            if (OnsetFires(strips[i], onset))
+                fired |= static_cast<uint16_t>(1 << i);
+        }
+        shared.push_back(fired);
+    }
+}
+
+// --- Accuracy ---
+
+struct Accuracy {
+    int hits;                   // beats a strip fired on
+    int misses;                 // beats a strip did not fire on
+    int falseAlarms;            // pulses not near a beat
+    double latency;             // frames from beat to pulse, summed over hits
+};
+
+// Match one strip's pulses to the beats, greedily in time order
+static void Score(const std::vector<uint16_t>& fired, int strip, const std::vector<int>& beats, Accuracy& acc) {
+    std::vector<int> events;
+    for (size_t f = 0; f < fired.size(); f++) {
+        if (fired[f] & (1 << strip))
+            events.push_back(static_cast<int>(f));
+    }
+    size_t e = 0;
+    for (int beat : beats) {
+        while (e < events.size() && events[e] < beat - ONSET_TOLERANCE) {
+            acc.falseAlarms++;
+            e++;
+        }
+        if (e < events.size() && events[e] <= beat + ONSET_TOLERANCE) {
+            acc.hits++;
+            acc.latency += events[e] - beat;
+            e++;
+        } else {
+            acc.misses++;
+        }
+    }
+    acc.falseAlarms += static_cast<int>(events.size() - e);
+}
+
+static void ReportAccuracy(const char* name, const std::vector<uint16_t>& fired, const std::vector<int>& beats) {
+    Accuracy total = {};
+    printf("%-10s", name);
+    for (int i = 0; i < 10; i++) {
+        Accuracy acc = {};
+        Score(fired, i, beats, acc);
+        printf("%5.0f%%", beats.empty() ? 0.0 : 100.0 * acc.hits / beats.size());
+        total.hits += acc.hits;
+        total.misses += acc.misses;
+        total.falseAlarms += acc.falseAlarms;
+        total.latency += acc.latency;
+    }
+    double precision = total.hits + total.falseAlarms ? 100.0 * total.hits / (total.hits + total.falseAlarms) : 0.0;
+    double recall = total.hits + total.misses ? 100.0 * total.hits / (total.hits + total.misses) : 0.0;
+    printf("   %9.1f%%%9.1f%%%10.2f\n", precision, recall, total.hits ? total.latency / total.hits : 0.0);
+}
+
+// Pulses per minute on each strip, and how many of one detector's pulses the other fired
+// within ONSET_TOLERANCE frames on the same strip
+static void ReportAgreement(const std::vector<Frame>& frames, const std::vector<uint16_t>& legacy,
+                            const std::vector<uint16_t>& shared) {
+    double minutes = (frames.back().timestamp - frames.front().timestamp) / 60.0;
+    const std::vector<uint16_t>* sets[2] = { &legacy, &shared };
+    const char* names[2] = { "legacy", "onset" };
+    for (int d = 0; d < 2; d++) {
+        const std::vector<uint16_t>& mine = *sets[d];
+        const std::vector<uint16_t>& other = *sets[1 - d];
+        int events = 0, agreed = 0;
+        printf("%-10s", names[d]);
+        for (int i = 0; i < 10; i++) {
+            int stripEvents = 0;
+            for (size_t f = 0; f < mine.size(); f++) {
+                if (!(mine[f] & (1 << i)))
+                    continue;
+                stripEvents++;
+                size_t lo = f >= static_cast<size_t>(ONSET_TOLERANCE) ? f - ONSET_TOLERANCE : 0;
+                size_t hi = std::min(f + ONSET_TOLERANCE, other.size() - 1);
+                for (size_t g = lo; g <= hi; g++) {
+                    if (other[g] & (1 << i)) {
+                        agreed++;
+                        break;
+                    }
+                }
+            }
+            events += stripEvents;
+            printf("%6.0f", minutes > 0.0 ? stripEvents / minutes : 0.0);
+        }
+        printf("   %8.1f%% also fired by %s\n", events ? 100.0 * agreed / events : 0.0, names[1 - d]);
+    }
+}
+
+// --- Cost ---
+// In the hook the frame was just written and is in cache, so frames are timed in chunks that
+// are read once untimed first; a whole capture would measure memory bandwidth instead.
+
+static constexpr size_t COST_CHUNK = 64;   // frames, ~80 KB
+static volatile uint32_t g_sink;
+
+static void TouchFrames(const Frame* frames, size_t count) {
+    uint32_t sum = 0;
+    for (size_t f = 0; f < count; f++)
+        sum += SumBytes(frames[f].data, FRAME_BYTES);
+    g_sink = sum;
+}
+
+static double TimeLegacy(const std::vector<Frame>& frames, int passes) {
+    double ns = 0.0;
+    for (int p = 0; p < passes; p++) {
+        LegacyDetector det = {};
+        for (size_t c = 0; c < frames.size(); c += COST_CHUNK) {
+            size_t end = std::min(c + COST_CHUNK, frames.size());
+            TouchFrames(&frames[c], end - c);
+            auto start = std::chrono::steady_clock::now();
+            uint32_t fired = 0;
+            for (size_t f = c; f < end; f++)
+                fired += DetectLegacy(det, frames[f].data);
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            g_sink = fired;
+        }
+    }
+    return ns / (static_cast<double>(passes) * frames.size());
+}
+
+static double TimeOnset(const std::vector<Frame>& frames, const StripTransform strips[10], int passes) {
+    static OnsetDetector det;
+    double ns = 0.0;
+    for (int p = 0; p < passes; p++) {
+        memset(&det, 0, sizeof(det));
+        FrameClock clock = StartFrameClock(frames.front().timestamp);
+        for (size_t c = 0; c < frames.size(); c += COST_CHUNK) {
+            size_t end = std::min(c + COST_CHUNK, frames.size());
+            TouchFrames(&frames[c], end - c);
+            auto start = std::chrono::steady_clock::now();
+            uint32_t fired = 0;
+            for (size_t f = c; f < end; f++) {
+                TickFrameClock(clock, frames[f].timestamp);
+                fired += OnsetFires(strips[0], DetectOnset(det, strips, frames[f].data, ALL_STRIPS, clock));
+            }
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            g_sink = fired;
+        }
+    }
+    return ns / (static_cast<double>(passes) * frames.size());
+}
+
+int main(int argc, char** argv) {
+    const char* capturePath = nullptr;
+    const char* iniPath = nullptr;
+    int passes = 20;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ini") == 0 && i + 1 < argc)
+            iniPath = argv[++i];
+        else if (strcmp(argv[i], "--passes") == 0 && i + 1 < argc)
+            passes = std::max(1, atoi(argv[++i]));
+        else if (argv[i][0] != '-')
+            capturePath = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [capture.sdvxcap] [--ini sdvxrgb.ini] [--passes N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Onset weights and sensitivities from the INI, or the defaults
+    static StripTransform strips[10];
+    ResetStrips(strips);
+    if (iniPath) {
+        IniFile iniFile;
+        if (!LoadIniFile(iniFile, iniPath)) {
+            fprintf(stderr, "cannot read %s\n", iniPath);
+            return 1;
+        }
+        LoadStrips(strips, MakeIniSource(iniFile));
+    }
+
+    std::vector<Frame> frames;
+    std::vector<int> beats;
+    if (capturePath) {
+        if (!LoadCapture(capturePath, frames) || frames.empty()) {
+            fprintf(stderr, "cannot read frames from %s\n", capturePath);
+            return 1;
+        }
+        printf("%zu frames, %.1f s recorded\n", frames.size(), frames.back().timestamp - frames.front().timestamp);
+    } else {
+        MakeSyntheticTrack(frames, beats);
+        printf("synthetic track: %zu frames, %zu beats\n", frames.size(), beats.size());
+    }
+
+    InitSimd();
+    std::vector<uint16_t> legacy, shared;
+    RunDetectors(frames, strips, legacy, shared);
+
+    if (capturePath) {
+        printf("\npulses per minute by strip, and agreement (within %d frames on the same strip)\n", ONSET_TOLERANCE);
+        printf("%-10s", "");
+        for (int i = 0; i < 10; i++)
+            printf("%6d", i);
+        printf("\n");
+        ReportAgreement(frames, legacy, shared);
+    } else {
+        printf("\nbeats fired on by strip, and over all strips (within %d frames)\n", ONSET_TOLERANCE);
+        printf("%-10s", "");
+        for (int i = 0; i < 10; i++)
+            printf("%6d", i);
+        printf("   %10s%10s%10s\n", "precision", "recall", "latency");
+        ReportAccuracy("legacy", legacy, beats);
+        ReportAccuracy("onset", shared, beats);
+    }
+
+    printf("\ncost per frame, all strips, %d passes\n", passes);
+    printf("%-22s%10.1f ns\n", "legacy (scalar)", TimeLegacy(frames, passes));
+    SimdLevel best = GetSimdLevel();
+    for (int level = SIMD_SCALAR; level <= best; level++) {
+        SetSimdLevel(static_cast<SimdLevel>(level));
+        char name[32];
+        snprintf(name, sizeof(name), "onset (%s)", SimdLevelName(static_cast<SimdLevel>(level)));
+        printf("%-22s%10.1f ns\n", name, TimeOnset(frames, strips, passes));
+    }
+    SetSimdLevel(best);
+    return 0;
+}
@@ -0,0 +1,401 @@
+// Capture-replay benchmark for the hook pipeline.
+//
+// Feeds the frames of a .sdvxcap file (Tools/sdvx_rgb_capture.py record) through TransformFrame,
+// the path SetTapeLedDataHook runs once a frame is complete: beat detection, transform, pulses
+// and fade for every strip. Time is the capture's own timestamps, so pulses and fades behave as
+// they did when recorded. Frame timings come from whole-frame calls; per-strip timings from
+// separate passes that call TransformFrame one strip at a time. The cached column is the share
+// of strips answered from the unchanged-input cache instead of running the stages.
+//
+// The capture holds what the hook wrote to shared memory, i.e. already transformed data;
+// record with an empty sdvxrgb.ini to capture the game's raw frames.
+//
+// As in the hook, every frame takes its config from a ConfigSwap. During the --realtime pass a
+// polling ConfigWatcher reloads the INI when it changes, so edits show up mid-replay.
+//
+// --async adds a pass through the hook's async mode: this thread plays the game, copying each
+// strip into the AsyncFrameQueue, and a worker thread transforms the frames. It reports what
+// the game thread pays per frame against the synchronous path, and the queue-to-output latency.
+// Frames are fed at the recorded timestamps with --realtime, otherwise as fast as the worker
+// keeps up (waiting untimed while the queue is full), so the output must match the sync passes.
+//
+// --stats adds flat-out passes with the hook's latency instrumentation on (stats_protocol.h) and
+// reports the per-stage histograms, and what the instrumentation adds to a frame.
+//
+// Built by the CMake project in SDVXTapeLedHook/ as replay_bench:
+//   replay_bench <capture.sdvxcap> <sdvxrgb.ini> [--passes N] [--realtime] [--async] [--stats]
+#include "ini_file.h"
+#include "async_frame.h"
+#include "config_watch.h"
+#include "frame.h"
+#include "stats_protocol.h"
+#include "transform_simd.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static constexpr int CAPTURE_FRAME_SIZE = 8 + FRAME_BYTES;  // double timestamp + RGB data
+static constexpr int WATCH_POLL_MS = 250;
+
+struct Frame {
+    double timestamp;
+    uint8_t data[FRAME_BYTES];
+};
+
+static bool LoadCapture(const char* path, std::vector<Frame>& frames) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    uint8_t buf[CAPTURE_FRAME_SIZE];
+    while (fread(buf, 1, CAPTURE_FRAME_SIZE, f) == CAPTURE_FRAME_SIZE) {
+        Frame frame;
+        memcpy(&frame.timestamp, buf, 8);
+        memcpy(frame.data, buf + 8, FRAME_BYTES);
+        frames.push_back(frame);
+    }
+    fclose(f);
+    return true;
+}
+
+// Per-call timings of one strip and of whole frames
+struct Samples {
+    std::vector<double> strip[10];
+    std::vector<double> frame;
+    uint64_t cacheHits[10] = {};
+    uint64_t cacheMisses[10] = {};
+};
+
+static double HitPercent(uint64_t hits, uint64_t misses) {
+    return hits + misses ? 100.0 * hits / (hits + misses) : 0.0;
+}
+
+static double Percentile(std::vector<double>& v, double p) {
+    if (v.empty())
+        return 0.0;
+    size_t i = static_cast<size_t>(p * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+static double Mean(const std::vector<double>& v) {
+    double sum = 0.0;
+    for (double x : v)
+        sum += x;
+    return v.empty() ? 0.0 : sum / v.size();
+}
+
+// One pass over the capture with fresh state, as if the game had just started.
+// realtime = wait for each frame's recorded timestamp instead of running flat out.
+// perStrip = time each strip separately (the frame sample is then their sum).
+// stats = time the stages into these histograms, as the hook does while stats are enabled.
+static void Replay(const std::vector<Frame>& frames, ConfigSwap& swap, bool realtime,
+                   bool perStrip, Samples& samples, unsigned& checksum, StatsBlock* stats = nullptr) {
+    static FrameState state;
+    memset(&state, 0, sizeof(state));
+    static uint8_t shm[FRAME_BYTES];
+
+    // The effects run on the recorded timestamps (virtual time) whether or not the pass is paced
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    VirtualClock time = { frames.front().timestamp };
+    TimeSource source = VirtualTimeSource(time);
+    FrameClock clock = StartFrameClock(source);
+
+    for (const Frame& frame : frames) {
+        if (realtime) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(frame.timestamp - frames.front().timestamp)));
+        }
+        time.time = frame.timestamp;
+        TickFrameClock(clock, source);
+        const StripTransform* strips = AcquireConfig(swap).strips;
+
+        if (perStrip) {
+            // The frame's onset first, over all strips, as the whole-frame call measures it
+            Clock::time_point onsetStart = Clock::now();
+            DetectOnset(state.onset, strips, frame.data, ALL_STRIPS, clock);
+            double total = std::chrono::duration<double, std::nano>(Clock::now() - onsetStart).count();
+            for (int i = 0; i < 10; i++) {
+                Clock::time_point stripStart = Clock::now();
+                TransformFrame(strips, state, frame.data, shm, clock, static_cast<uint16_t>(1 << i));
+                Clock::time_point stripEnd = Clock::now();
+                double ns = std::chrono::duration<double, std::nano>(stripEnd - stripStart).count();
+                samples.strip[i].push_back(ns);
+                total += ns;
+            }
+            samples.frame.push_back(total);
+        } else {
+            Clock::time_point frameStart = Clock::now();
+            TransformFrame(strips, state, frame.data, shm, clock, ALL_STRIPS, stats ? stats->strips : nullptr);
+            Clock::time_point frameEnd = Clock::now();
+            samples.frame.push_back(std::chrono::duration<double, std::nano>(frameEnd - frameStart).count());
+        }
+
+        for (int i = 0; i < FRAME_BYTES; i += 61)
+            checksum = checksum * 31 + shm[i];
+    }
+
+    for (int i = 0; i < 10; i++) {
+        samples.cacheHits[i] += state.strips[i].cache.hits;
+        samples.cacheMisses[i] += state.strips[i].cache.misses;
+    }
+}
+
+// Async mode: per-frame game-thread cost (samples.frame) and queue-to-output latency
+struct AsyncSamples {
+    std::vector<double> producer;
+    std::vector<double> latency;
+    uint64_t dropped;
+};
+
+// One pass in async mode. The replayed frame times stay the recorded ones: only the game
+// thread's wall time is measured, via the steady clock that also stamps the queued frames.
+static void ReplayAsync(const std::vector<Frame>& frames, ConfigSwap& swap, bool realtime,
+                        AsyncSamples& samples, unsigned& checksum) {
+    static FrameState state;
+    memset(&state, 0, sizeof(state));
+    static AsyncFrameQueue queue;
+    static AsyncProducer producer;
+    memset(&producer, 0, sizeof(producer));
+    static std::vector<double> recordedTime;   // queued frame -> its recorded timestamp
+    recordedTime.assign(frames.size(), 0.0);
+    std::atomic<bool> done(false);
+    TimeSource steady = SteadyTimeSource();
+
+    // Worker: like the hook's, but the frame clock runs on the recorded timestamps
+    std::thread worker([&] {
+        static uint8_t shm[FRAME_BYTES];
+        FrameClock clock = StartFrameClock(frames.front().timestamp);
+        size_t index = 0;
+        for (;;) {
+            AsyncFrame* frame = queue.Front();
+            if (!frame) {
+                if (done.load(std::memory_order_acquire) && !queue.Front())
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+            TickFrameClock(clock, recordedTime[index++]);
+            TransformFrame(AcquireConfig(swap).strips, state, frame->rgb, shm, clock, frame->strips);
+            samples.latency.push_back((ReadTime(steady) - frame->time) * 1e9);
+            for (int i = 0; i < FRAME_BYTES; i += 61)
+                checksum = checksum * 31 + shm[i];
+            queue.Pop();
+        }
+    });
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    for (const Frame& frame : frames) {
+        if (realtime) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(frame.timestamp - frames.front().timestamp)));
+        } else {
+            while (queue.Size() == ASYNC_QUEUE_DEPTH)
+                std::this_thread::yield();
+        }
+        recordedTime[producer.queued] = frame.timestamp;
+
+        // What the hook does on the game thread for each of the frame's strips
+        Clock::time_point frameStart = Clock::now();
+        for (int i = 0; i < 10; i++)
+            PushAsyncStrip(queue, producer, i, frame.data + StripByteOffset[i], steady);
+        Clock::time_point frameEnd = Clock::now();
+        samples.producer.push_back(std::chrono::duration<double, std::nano>(frameEnd - frameStart).count());
+    }
+    done.store(true, std::memory_order_release);
+    worker.join();
+    samples.dropped += producer.dropped;
+}
+
+static void ReportAsync(AsyncSamples& samples, const Samples& sync) {
+    std::vector<double> syncFrame = sync.frame;
+    printf("\nasync mode\n");
+    printf("%-22s%10s%10s%10s%10s   (ns)\n", "", "mean", "p50", "p99", "max");
+    printf("%-22s%10.1f%10.1f%10.1f%10.1f\n", "game thread, sync", Mean(syncFrame),
+           Percentile(syncFrame, 0.50), Percentile(syncFrame, 0.99),
+           syncFrame.empty() ? 0.0 : *std::max_element(syncFrame.begin(), syncFrame.end()));
+    std::vector<double>* rows[2] = { &samples.producer, &samples.latency };
+    const char* names[2] = { "game thread, async", "queue -> output" };
+    for (int r = 0; r < 2; r++) {
+        std::vector<double>& v = *rows[r];
+        printf("%-22s%10.1f%10.1f%10.1f%10.1f\n", names[r], Mean(v), Percentile(v, 0.50),
+               Percentile(v, 0.99), v.empty() ? 0.0 : *std::max_element(v.begin(), v.end()));
+    }
+    printf("%llu frames dropped (queue depth %u)\n", static_cast<unsigned long long>(samples.dropped),
+           ASYNC_QUEUE_DEPTH);
+}
+
+// Per-stage latencies from the stats histograms, all strips merged, against the frame time
+// without instrumentation
+static void ReportStats(const StatsBlock& stats, Samples& on, Samples& off) {
+    static const StatsStripStage stages[3] = { STATS_STAGE_BEAT, STATS_STAGE_TRANSFORM, STATS_STAGE_FADE };
+    static const char* names[3] = { "beat", "transform", "fade" };
+    double nsPerTick = 1e9 / static_cast<double>(stats.ticksPerSecond);
+    uint64_t timed = 0;
+
+    printf("\nhook instrumentation\n");
+    printf("%-22s%10s%10s%10s%10s   (ns, p50/p99 are bucket bounds)\n", "stage", "mean", "p50", "p99", "max");
+    for (int s = 0; s < 3; s++) {
+        uint32_t buckets[STATS_BUCKETS] = {};
+        uint64_t count = 0, sum = 0, max = 0;
+        for (int i = 0; i < 10; i++) {
+            const StatsHistogram& h = stats.strips[i].stages[stages[s]];
+            for (int b = 0; b < STATS_BUCKETS; b++)
+                buckets[b] += h.buckets[b];
+            count += h.count;
+            timed += h.count;
+            sum += h.sumTicks;
+            max = std::max(max, h.maxTicks);
+        }
+        printf("%-22s%10.1f%10.1f%10.1f%10.1f\n", names[s], count ? sum * nsPerTick / count : 0.0,
+               StatsPercentile(buckets, 0.50) * nsPerTick, StatsPercentile(buckets, 0.99) * nsPerTick,
+               max * nsPerTick);
+    }
+
+    // Strips answered from the cache time no stages
+    double onMean = Mean(on.frame), offMean = Mean(off.frame);
+    double stagesPerFrame = on.frame.empty() ? 0.0 : static_cast<double>(timed) / on.frame.size();
+    printf("frame %.1f ns with stats, %.1f ns without: %.1f ns per timed stage\n", onMean, offMean,
+           stagesPerFrame > 0.0 ? (onMean - offMean) / stagesPerFrame : 0.0);
+}
+
+static void Report(const char* title, Samples& samples, double wallSeconds) {
+    int totalLEDs = 0;
+    for (int i = 0; i < 10; i++)
+        totalLEDs += StripLedCount[i];
+
+    printf("\n%s\n", title);
+    printf("%-22s%8s%10s%10s%10s%10s%9s   (ns)\n", "strip", "LEDs", "mean", "p50", "p99", "max", "cached");
+    uint64_t hits = 0, misses = 0;
+    for (int i = 0; i < 10; i++) {
+        std::vector<double>& v = samples.strip[i];
+        double mean = Mean(v);
+        double p50 = Percentile(v, 0.50);
+        double p99 = Percentile(v, 0.99);
+        double max = v.empty() ? 0.0 : *std::max_element(v.begin(), v.end());
+        printf("%-22s%8d%10.1f%10.1f%10.1f%10.1f%8.1f%%\n", StripSectionNames[i], StripLedCount[i],
+               mean, p50, p99, max, HitPercent(samples.cacheHits[i], samples.cacheMisses[i]));
+        hits += samples.cacheHits[i];
+        misses += samples.cacheMisses[i];
+    }
+
+    std::vector<double>& f = samples.frame;
+    double mean = Mean(f);
+    double p50 = Percentile(f, 0.50);
+    double p99 = Percentile(f, 0.99);
+    double max = f.empty() ? 0.0 : *std::max_element(f.begin(), f.end());
+    printf("%-22s%8d%10.1f%10.1f%10.1f%10.1f%8.1f%%\n", "frame", totalLEDs, mean, p50, p99, max,
+           HitPercent(hits, misses));
+    printf("%zu frames in %.3f s, %.0f frames/s of pipeline time (%.1f M LEDs/s)\n",
+           f.size(), wallSeconds, 1e9 / mean, totalLEDs * 1e3 / mean);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <capture.sdvxcap> <sdvxrgb.ini> [--passes N] [--realtime] [--async] [--stats]\n",
+                argv[0]);
+        return 2;
+    }
+    int passes = 20;
+    bool realtime = false;
+    bool async = false;
+    bool stats = false;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--passes") == 0 && i + 1 < argc)
+            passes = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--realtime") == 0)
+            realtime = true;
+        else if (strcmp(argv[i], "--async") == 0)
+            async = true;
+        else if (strcmp(argv[i], "--stats") == 0)
+            stats = true;
+    }
+
+    std::vector<Frame> frames;
+    if (!LoadCapture(argv[1], frames) || frames.empty()) {
+        fprintf(stderr, "cannot read frames from %s\n", argv[1]);
+        return 1;
+    }
+
+    IniFile iniFile;
+    if (!LoadIniFile(iniFile, argv[2])) {
+        fprintf(stderr, "cannot read %s\n", argv[2]);
+        return 1;
+    }
+
+    InitSimd();
+    static ConfigSwap swap;
+    InitConfigSwap(swap, BuildStripConfig(&iniFile));
+
+    double duration = frames.back().timestamp - frames.front().timestamp;
+    printf("%zu frames, %.1f s recorded, SIMD %s\n", frames.size(), duration,
+           SimdLevelName(GetSimdLevel()));
+
+    // Whole-frame passes for the frame row, per-strip passes for the strip rows
+    unsigned checksum = 0;
+    Samples fast, perStrip;
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; p++)
+        Replay(frames, swap, false, false, fast, checksum);
+    auto end = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; p++)
+        Replay(frames, swap, false, true, perStrip, checksum);
+    for (int i = 0; i < 10; i++)
+        fast.strip[i].swap(perStrip.strip[i]);
+    char title[64];
+    snprintf(title, sizeof(title), "flat out, %d passes", passes);
+    Report(title, fast, std::chrono::duration<double>(end - start).count());
+
+    if (realtime) {
+        static ConfigWatcher watcher;
+        StartConfigWatcher(watcher, swap, argv[2], WATCH_POLL_MS);
+        Samples paced;
+        start = std::chrono::steady_clock::now();
+        Replay(frames, swap, true, true, paced, checksum);
+        end = std::chrono::steady_clock::now();
+        StopConfigWatcher(watcher);
+        Report("at recorded timestamps", paced, std::chrono::duration<double>(end - start).count());
+        if (watcher.reloads > 0)
+            printf("%d config reloads during the pass\n", watcher.reloads.load());
+    }
+
+    if (async) {
+        // The async output must match a sync pass over the same frames unless frames were dropped
+        unsigned syncChecksum = 0, asyncChecksum = 0;
+        Samples reference;
+        Replay(frames, swap, false, false, reference, syncChecksum);
+        AsyncSamples asyncSamples = {};
+        ReplayAsync(frames, swap, realtime, asyncSamples, asyncChecksum);
+        ReportAsync(asyncSamples, fast);
+        if (asyncSamples.dropped == 0)
+            printf("async output %s the sync path\n", asyncChecksum == syncChecksum ? "matches" : "DIFFERS from");
+    }
+
+    if (stats) {
+        // Same flat-out passes with the stages timed; the stats clock is calibrated over them
+        static StatsBlock block;
+        InitStatsBlock(&block, 10, 0, true);
+        unsigned statsChecksum = 0;
+        Samples on, off;
+        uint64_t ticksStart = StatsTimestamp();
+        start = std::chrono::steady_clock::now();
+        for (int p = 0; p < passes; p++)
+            Replay(frames, swap, false, false, on, statsChecksum, &block);
+        end = std::chrono::steady_clock::now();
+        block.ticksPerSecond = static_cast<int64_t>((StatsTimestamp() - ticksStart) /
+                                                    std::chrono::duration<double>(end - start).count());
+        for (int p = 0; p < passes; p++)
+            Replay(frames, swap, false, false, off, statsChecksum);
+        ReportStats(block, on, off);
+    }
+
+    printf("\nchecksum %08x\n", checksum);
+    DestroyConfigSwap(swap);
+    return 0;
+}
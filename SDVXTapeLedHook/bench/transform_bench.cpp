@@ -0,0 +1,251 @@
+// Microbenchmark for TransformStrip.
+//
+// Checks every SIMD level against the scalar kernels and prints ns/strip for the
+// cabinet's strip sizes at each level the CPU supports. Then compares the generic
+// plan interpreter (RunPlan) against the specialized kernel for several pipelines, and
+// the table-driven pulse renderer against the float renderer it replaced.
+//
+// Built by the CMake project in SDVXTapeLedHook/ as transform_bench.
+#include "config.h"
+#include "transform_simd.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <algorithm>
+
+static const int StripSizes[] = { 12, 56, 86, 94 };
+static constexpr int ITERATIONS = 200000;
+
+static bool VerifyLevel(SimdLevel level) {
+    std::mt19937 rng(1234);
+    static const int Brightness[] = { 0, 37, 80, 100, 150, 200 };
+    uint8_t input[282], expect[282], actual[282];
+
+    for (int order = 0; order < 6; order++) {
+        for (int br : Brightness) {
+            for (int numBytes = 0; numBytes <= 282; numBytes += 3) {
+                for (int i = 0; i < numBytes; i++)
+                    input[i] = static_cast<uint8_t>(rng());
+
+                SetSimdLevel(SIMD_SCALAR);
+                memcpy(expect, input, numBytes);
+                SwizzleChannels(static_cast<ChannelOrder>(order), expect, numBytes);
+                ScaleBrightness(expect, numBytes, br);
+
+                SetSimdLevel(level);
+                memcpy(actual, input, numBytes);
+                SwizzleChannels(static_cast<ChannelOrder>(order), actual, numBytes);
+                ScaleBrightness(actual, numBytes, br);
+
+                if (memcmp(expect, actual, numBytes) != 0) {
+                    printf("MISMATCH %s: order=%d brightness=%d bytes=%d\n",
+                           SimdLevelName(level), order, br, numBytes);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static double BenchStrip(const StripTransform& strip, StripKernelFn run, int numLEDs, unsigned& checksum) {
+    uint8_t source[282], data[282];
+    for (int i = 0; i < numLEDs * 3; i++)
+        source[i] = static_cast<uint8_t>(i * 37);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < ITERATIONS; it++) {
+        memcpy(data, source, numLEDs * 3);
+        run(strip, data, numLEDs * 3);
+        checksum += data[it % (numLEDs * 3)];
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+}
+
+static void BenchKernels(const StripTransform& identity, unsigned& checksum) {
+    struct Case {
+        const char* name;
+        StripTransform strip;
+    };
+    static Case cases[4];
+    for (Case& c : cases) {
+        c.strip = identity;
+        c.strip.enabled = true;
+        c.strip.lut_max_error = 0;  // exact path, not the 3D LUT
+    }
+
+    cases[0].name = "swizzle+brightness";
+    cases[0].strip.channelOrder = CH_GBR;
+    cases[0].strip.brightness = 80;
+
+    cases[1].name = "hue+saturation";
+    cases[1].strip.channelOrder = CH_GRB;
+    cases[1].strip.hue_shift = 90;
+    cases[1].strip.saturation = 130;
+
+    cases[2].name = "static+contrast";
+    cases[2].strip.static_color_enabled = true;
+    cases[2].strip.static_r = 0xFE;
+    cases[2].strip.static_g = 0x01;
+    cases[2].strip.static_b = 0xE4;
+    cases[2].strip.contrast = 150;
+    cases[2].strip.brightness = 120;
+
+    cases[3].name = "gradient";
+    cases[3].strip.static_color_enabled = true;
+    cases[3].strip.static_b = 0xFF;
+    cases[3].strip.gradient_enabled = true;
+    cases[3].strip.gradient_count = 1;
+    cases[3].strip.gradient_rgb[0][0] = 0xFF;
+    cases[3].strip.gradient_rgb[0][2] = 0xFF;
+    cases[3].strip.gradient_pos[0] = 1.0f;
+
+    SetSimdLevel(DetectSimdLevel());
+    printf("\n%-20s%-8s%12s%12s   (ns/strip)\n", "pipeline", "LEDs", "generic", "kernel");
+    for (Case& c : cases) {
+        BuildPlan(c.strip, MAX_STRIP_LEDS, c.name);
+        for (int numLEDs : StripSizes) {
+            double generic = BenchStrip(c.strip, RunPlan, numLEDs, checksum);
+            double kernel = BenchStrip(c.strip, c.strip.kernel, numLEDs, checksum);
+            printf("%-20s%-8d%12.1f%12.1f\n", c.name, numLEDs, generic, kernel);
+        }
+    }
+}
+
+// The per-LED cosf pulse pass TransformStrip used before the falloff table
+static void RenderPulsesFloat(const StripTransform& strip, const float* positions, int count,
+                              uint8_t* data, int numBytes) {
+    int numLEDs = numBytes / 3;
+    float totalHalf = strip.pulse_width + strip.pulse_fade;
+    for (int p = 0; p < count; p++) {
+        float pos = positions[p];
+        int minLED = std::max(0, static_cast<int>(pos - totalHalf));
+        int maxLED = std::min(numLEDs - 1, static_cast<int>(pos + totalHalf));
+        for (int led = minLED; led <= maxLED; led++) {
+            float dist = fabsf(static_cast<float>(led) - pos);
+            float blend;
+            if (dist <= strip.pulse_width) {
+                blend = 1.0f;
+            } else if (dist < totalHalf) {
+                float t = (dist - strip.pulse_width) / strip.pulse_fade;
+                blend = 0.5f * (1.0f + cosf(t * 3.14159265f));
+            } else {
+                continue;
+            }
+            int idx = led * 3;
+            data[idx]     = static_cast<uint8_t>(std::min(255, data[idx]     + static_cast<int>(strip.pulse_r * blend)));
+            data[idx + 1] = static_cast<uint8_t>(std::min(255, data[idx + 1] + static_cast<int>(strip.pulse_g * blend)));
+            data[idx + 2] = static_cast<uint8_t>(std::min(255, data[idx + 2] + static_cast<int>(strip.pulse_b * blend)));
+        }
+    }
+}
+
+// Spread count pulses evenly along the strip, as a dense chart would
+static void SpreadPulses(PulseRing& ring, float* positions, int count, int numLEDs, int capacity) {
+    ring = {};
+    float gap = static_cast<float>(numLEDs) / count;
+    for (int p = 0; p < count; p++) {
+        AdvancePulses(ring, p == 0 ? 0.0f : gap, numLEDs + count);
+        SpawnPulse(ring, capacity);
+    }
+    for (int p = 0; p < count; p++)
+        positions[p] = static_cast<float>(PulsePosition(ring, p)) / PULSE_POS_ONE;
+}
+
+static void BenchPulses(const StripTransform& identity, unsigned& checksum) {
+    static const int PulseCounts[] = { 1, 8, 32, 64, 128 };
+    StripTransform strip = identity;
+    strip.enabled = true;
+    strip.pulse_color_enabled = true;
+    strip.pulse_r = 0x40;
+    strip.pulse_g = 0x20;
+    strip.pulse_b = 0xFF;
+    strip.pulse_capacity = MAX_PULSE_CAPACITY;
+    BuildPlan(strip, MAX_STRIP_LEDS, "pulse");
+
+    static PulseRing ring;
+    float positions[MAX_PULSE_CAPACITY];
+    uint8_t expect[282], actual[282];
+
+    printf("\n%-8s%-8s%12s%12s%12s%12s%8s\n", "LEDs", "pulses",
+           "float/strip", "float/pulse", "table/strip", "table/pulse", "maxerr");
+    for (int numLEDs : StripSizes) {
+        int numBytes = numLEDs * 3;
+        for (int count : PulseCounts) {
+            SpreadPulses(ring, positions, count, numLEDs, strip.pulse_capacity);
+
+            int maxErr = 0;
+            memset(expect, 0, numBytes);
+            memset(actual, 0, numBytes);
+            RenderPulsesFloat(strip, positions, count, expect, numBytes);
+            RenderPulses(strip.plan.pulse, ring, actual, numBytes);
+            for (int i = 0; i < numBytes; i++)
+                maxErr = std::max(maxErr, std::abs(expect[i] - actual[i]));
+
+            auto start = std::chrono::steady_clock::now();
+            for (int it = 0; it < ITERATIONS; it++) {
+                memset(expect, 0, numBytes);
+                RenderPulsesFloat(strip, positions, count, expect, numBytes);
+                checksum += expect[it % numBytes];
+            }
+            auto mid = std::chrono::steady_clock::now();
+            for (int it = 0; it < ITERATIONS; it++) {
+                memset(actual, 0, numBytes);
+                RenderPulses(strip.plan.pulse, ring, actual, numBytes);
+                checksum += actual[it % numBytes];
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            double floatNs = std::chrono::duration<double, std::nano>(mid - start).count() / ITERATIONS;
+            double tableNs = std::chrono::duration<double, std::nano>(end - mid).count() / ITERATIONS;
+            printf("%-8d%-8d%12.1f%12.2f%12.1f%12.2f%8d\n", numLEDs, count,
+                   floatNs, floatNs / count, tableNs, tableNs / count, maxErr);
+        }
+    }
+}
+
+int main() {
+    InitSimd();
+    static StripTransform identity;
+    SetDefaultStrip(identity);
+
+    // Swizzle + brightness: the pipeline that runs fully vectorized
+    static StripTransform strip;
+    strip = identity;
+    strip.enabled = true;
+    strip.channelOrder = CH_GBR;
+    strip.brightness = 80;
+    BuildPlan(strip, MAX_STRIP_LEDS, "bench");
+
+    SimdLevel best = DetectSimdLevel();
+    printf("CPU supports: %s\n\n", SimdLevelName(best));
+
+    for (int level = SIMD_SSE41; level <= best; level++) {
+        if (!VerifyLevel(static_cast<SimdLevel>(level)))
+            return 1;
+        printf("%s matches scalar output\n", SimdLevelName(static_cast<SimdLevel>(level)));
+    }
+
+    printf("\n%-8s", "LEDs");
+    for (int level = SIMD_SCALAR; level <= best; level++)
+        printf("%12s", SimdLevelName(static_cast<SimdLevel>(level)));
+    printf("   (ns/strip)\n");
+
+    unsigned checksum = 0;
+    for (int numLEDs : StripSizes) {
+        printf("%-8d", numLEDs);
+        for (int level = SIMD_SCALAR; level <= best; level++) {
+            SetSimdLevel(static_cast<SimdLevel>(level));
+            printf("%12.1f", BenchStrip(strip, strip.kernel, numLEDs, checksum));
+        }
+        printf("\n");
+    }
+    BenchKernels(identity, checksum);
+    BenchPulses(identity, checksum);
+
+    printf("\nchecksum %u\n", checksum);
+    return 0;
+}
@@ -0,0 +1,313 @@
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+// Default max channel error (0-255) the 3D LUT may have before falling back to the exact path.
+// 0 = exact unless a strip opts in: the LUT is approximate and its error scan is slow.
+static constexpr int DEFAULT_LUT_MAX_ERROR = 0;
+
+// Default onset strength (deviations above the mean rise) that spawns a pulse
+static constexpr float DEFAULT_ONSET_SENSITIVITY = 3.0f;
+
+const char* StripSectionNames[10] = {
+    "title",
+    "upper_left_speaker",
+    "upper_right_speaker",
+    "left_wing",
+    "right_wing",
+    "ctrl_panel",
+    "lower_left_speaker",
+    "lower_right_speaker",
+    "woofer",
+    "v_unit"
+};
+
+const int StripLedCount[10] = { 74, 12, 12, 56, 56, 94, 12, 12, 14, 86 };
+
+// ASCII case-insensitive string compare
+static bool EqualsIgnoreCase(const char* a, const char* b) {
+    for (; *a && *b; a++, b++) {
+        char ca = (*a >= 'a' && *a <= 'z') ? static_cast<char>(*a - 32) : *a;
+        char cb = (*b >= 'a' && *b <= 'z') ? static_cast<char>(*b - 32) : *b;
+        if (ca != cb)
+            return false;
+    }
+    return *a == *b;
+}
+
+// Parse a ChannelOrder from a string like "RGB", "GBR", etc.
+static ChannelOrder ParseChannelOrder(const char* str) {
+    if (EqualsIgnoreCase(str, "RBG")) return CH_RBG;
+    if (EqualsIgnoreCase(str, "GRB")) return CH_GRB;
+    if (EqualsIgnoreCase(str, "GBR")) return CH_GBR;
+    if (EqualsIgnoreCase(str, "BRG")) return CH_BRG;
+    if (EqualsIgnoreCase(str, "BGR")) return CH_BGR;
+    return CH_RGB;
+}
+
+// Parse a FadeCurve from "linear", "exponential" or "ease_out"
+static FadeCurve ParseFadeCurve(const char* str, FadeCurve def) {
+    if (EqualsIgnoreCase(str, "linear")) return FADE_LINEAR;
+    if (EqualsIgnoreCase(str, "exponential")) return FADE_EXPONENTIAL;
+    if (EqualsIgnoreCase(str, "ease_out")) return FADE_EASE_OUT;
+    return def;
+}
+
+// Parse a hex color string like "8000FF" or "#8000FF" into r, g, b. Returns true on success.
+static bool ParseHexColor(const char* str, uint8_t& r, uint8_t& g, uint8_t& b) {
+    if (!str || str[0] == '\0')
+        return false;
+    const char* hex = str;
+    if (hex[0] == '#') hex++;
+    if (strlen(hex) != 6)
+        return false;
+    char* end;
+    unsigned long val = strtoul(hex, &end, 16);
+    if (end == hex)
+        return false;
+    r = static_cast<uint8_t>((val >> 16) & 0xFF);
+    g = static_cast<uint8_t>((val >> 8) & 0xFF);
+    b = static_cast<uint8_t>(val & 0xFF);
+    return true;
+}
+
+// Parse a gradient stop list like "FF00FF" or "00FF00@0.3, 0000FF": hex colors separated by
+// commas, each with an optional position 0-1. Stops without a position are spread evenly.
+// Returns the number of stops, 0 if any stop is malformed.
+static int ParseGradientStops(const char* str, uint8_t rgb[MAX_GRADIENT_STOPS][3], float pos[MAX_GRADIENT_STOPS]) {
+    bool hasPos[MAX_GRADIENT_STOPS];
+    int count = 0;
+    const char* p = str;
+    while (*p != '\0') {
+        if (count == MAX_GRADIENT_STOPS)
+            return 0;
+
+        const char* end = strchr(p, ',');
+        size_t len = end ? static_cast<size_t>(end - p) : strlen(p);
+        char token[32];
+        if (len >= sizeof(token))
+            return 0;
+        memcpy(token, p, len);
+        token[len] = '\0';
+
+        // Trim spaces, split off "@position"
+        char* t = token;
+        while (*t == ' ') t++;
+        char* at = strchr(t, '@');
+        hasPos[count] = (at != nullptr);
+        if (at) {
+            *at = '\0';
+            pos[count] = static_cast<float>(atof(at + 1));
+        }
+        for (char* e = t + strlen(t); e > t && e[-1] == ' '; e--)
+            e[-1] = '\0';
+
+        if (!ParseHexColor(t, rgb[count][0], rgb[count][1], rgb[count][2]))
+            return 0;
+        count++;
+        p = end ? end + 1 : p + len;
+    }
+
+    // Fill in default positions and keep them ordered within 0-1
+    float prev = 0.0f;
+    for (int i = 0; i < count; i++) {
+        if (!hasPos[i])
+            pos[i] = static_cast<float>(i + 1) / static_cast<float>(count);
+        pos[i] = std::min(std::max(pos[i], prev), 1.0f);
+        prev = pos[i];
+    }
+    return count;
+}
+
+// Read an integer value from INI (like GetPrivateProfileInt: leading digits, default if missing)
+static int GetIniInt(const IniSource& ini, const char* section, const char* key, int defaultVal) {
+    char buf[64];
+    ini.getString(ini.ctx, section, key, "", buf, sizeof(buf));
+    if (buf[0] == '\0')
+        return defaultVal;
+    return static_cast<int>(strtol(buf, nullptr, 10));
+}
+
+// Read a float value from INI (string then atof)
+static float GetIniFloat(const IniSource& ini, const char* section, const char* key, float defaultVal) {
+    char buf[64];
+    char defBuf[64];
+    snprintf(defBuf, sizeof(defBuf), "%.4f", defaultVal);
+    ini.getString(ini.ctx, section, key, defBuf, buf, sizeof(buf));
+    return static_cast<float>(atof(buf));
+}
+
+// Load settings for one strip from a given INI section, with fallback defaults.
+// numLEDs is the strip's LED count (0 for [global]).
+static void LoadStripFromSection(StripTransform& strip, const char* section, int numLEDs,
+                                  const StripTransform& defaults, const IniSource& ini) {
+    char orderStr[16];
+    // Determine the default channel order string for the lookup fallback
+    const char* defOrder = "RGB";
+    switch (defaults.channelOrder) {
+        case CH_RBG: defOrder = "RBG"; break;
+        case CH_GRB: defOrder = "GRB"; break;
+        case CH_GBR: defOrder = "GBR"; break;
+        case CH_BRG: defOrder = "BRG"; break;
+        case CH_BGR: defOrder = "BGR"; break;
+        default: defOrder = "RGB"; break;
+    }
+
+    ini.getString(ini.ctx, section, "channel_order", defOrder, orderStr, sizeof(orderStr));
+    strip.channelOrder = ParseChannelOrder(orderStr);
+
+    strip.gamma_r = GetIniFloat(ini, section, "gamma_r", defaults.gamma_r);
+    strip.gamma_g = GetIniFloat(ini, section, "gamma_g", defaults.gamma_g);
+    strip.gamma_b = GetIniFloat(ini, section, "gamma_b", defaults.gamma_b);
+
+    strip.hue_shift = GetIniInt(ini, section, "hue_shift", defaults.hue_shift);
+    strip.saturation = GetIniInt(ini, section, "saturation", defaults.saturation);
+    strip.brightness = GetIniInt(ini, section, "brightness", defaults.brightness);
+    strip.contrast = GetIniInt(ini, section, "contrast", defaults.contrast);
+
+    // Clamp values
+    strip.hue_shift = ((strip.hue_shift % 360) + 360) % 360;
+    strip.saturation = std::min(std::max(strip.saturation, 0), 200);
+    strip.brightness = std::min(std::max(strip.brightness, 0), 200);
+    strip.contrast = std::min(std::max(strip.contrast, 0), 200);
+
+    // Parse static_color (hex RGB like "8000FF" or "#8000FF")
+    char colorStr[16];
+    ini.getString(ini.ctx, section, "static_color", "", colorStr, sizeof(colorStr));
+    if (ParseHexColor(colorStr, strip.static_r, strip.static_g, strip.static_b)) {
+        strip.static_color_enabled = true;
+    } else {
+        strip.static_color_enabled = defaults.static_color_enabled;
+        strip.static_r = defaults.static_r;
+        strip.static_g = defaults.static_g;
+        strip.static_b = defaults.static_b;
+    }
+
+    // Parse gradient_color (stop list after static_color; requires static_color to be set)
+    char gradStr[256];
+    ini.getString(ini.ctx, section, "gradient_color", "", gradStr, sizeof(gradStr));
+    strip.gradient_count = 0;
+    if (strip.static_color_enabled)
+        strip.gradient_count = ParseGradientStops(gradStr, strip.gradient_rgb, strip.gradient_pos);
+    if (strip.gradient_count > 0) {
+        strip.gradient_enabled = true;
+    } else {
+        strip.gradient_enabled = defaults.gradient_enabled;
+        strip.gradient_count = defaults.gradient_count;
+        memcpy(strip.gradient_rgb, defaults.gradient_rgb, sizeof(strip.gradient_rgb));
+        memcpy(strip.gradient_pos, defaults.gradient_pos, sizeof(strip.gradient_pos));
+    }
+
+    // Parse pulse_color
+    char pulseStr[16];
+    ini.getString(ini.ctx, section, "pulse_color", "", pulseStr, sizeof(pulseStr));
+    if (ParseHexColor(pulseStr, strip.pulse_r, strip.pulse_g, strip.pulse_b)) {
+        strip.pulse_color_enabled = true;
+    } else {
+        strip.pulse_color_enabled = defaults.pulse_color_enabled;
+        strip.pulse_r = defaults.pulse_r;
+        strip.pulse_g = defaults.pulse_g;
+        strip.pulse_b = defaults.pulse_b;
+    }
+
+    strip.pulse_speed = GetIniFloat(ini, section, "pulse_speed", defaults.pulse_speed);
+    strip.pulse_width = GetIniFloat(ini, section, "pulse_width", defaults.pulse_width);
+    strip.pulse_fade = GetIniFloat(ini, section, "pulse_fade", defaults.pulse_fade);
+    strip.pulse_speed = std::max(strip.pulse_speed, 10.0f);
+    strip.pulse_width = std::max(strip.pulse_width, 0.0f);
+    strip.pulse_fade = std::max(strip.pulse_fade, 0.5f);
+    strip.pulse_capacity = GetIniInt(ini, section, "pulse_capacity", defaults.pulse_capacity);
+    strip.pulse_capacity = std::min(std::max(strip.pulse_capacity, 1), MAX_PULSE_CAPACITY);
+
+    strip.fade_in = GetIniFloat(ini, section, "fade_in", defaults.fade_in);
+    strip.fade_out = GetIniFloat(ini, section, "fade_out", defaults.fade_out);
+    strip.fade_in = std::max(strip.fade_in, 0.0f);
+    strip.fade_out = std::max(strip.fade_out, 0.0f);
+    char curveStr[32];
+    ini.getString(ini.ctx, section, "fade_curve", "", curveStr, sizeof(curveStr));
+    strip.fade_curve = ParseFadeCurve(curveStr, defaults.fade_curve);
+
+    strip.onset_weight = GetIniFloat(ini, section, "onset_weight", defaults.onset_weight);
+    strip.onset_sensitivity = GetIniFloat(ini, section, "onset_sensitivity", defaults.onset_sensitivity);
+    strip.onset_weight = std::min(std::max(strip.onset_weight, 0.0f), 100.0f);
+    strip.onset_sensitivity = std::min(std::max(strip.onset_sensitivity, 0.0f), 20.0f);
+
+    strip.lut_max_error = GetIniInt(ini, section, "lut_max_error", defaults.lut_max_error);
+    strip.lut_max_error = std::min(std::max(strip.lut_max_error, 0), 255);
+
+    // Determine if any transform is actually active
+    strip.enabled = (strip.channelOrder != CH_RGB ||
+                     strip.gamma_r != 1.0f ||
+                     strip.gamma_g != 1.0f ||
+                     strip.gamma_b != 1.0f ||
+                     strip.hue_shift != 0 ||
+                     strip.saturation != 100 ||
+                     strip.brightness != 100 ||
+                     strip.contrast != 100 ||
+                     strip.static_color_enabled ||
+                     strip.gradient_enabled ||
+                     strip.pulse_color_enabled ||
+                     strip.fade_in > 0.0f ||
+                     strip.fade_out > 0.0f);
+
+    // Compile the settings into the plan TransformStrip executes
+    BuildPlan(strip, numLEDs, section);
+}
+
+void SetDefaultStrip(StripTransform& strip) {
+    strip.enabled = false;
+    strip.channelOrder = CH_RGB;
+    strip.gamma_r = 1.0f;
+    strip.gamma_g = 1.0f;
+    strip.gamma_b = 1.0f;
+    strip.hue_shift = 0;
+    strip.saturation = 100;
+    strip.brightness = 100;
+    strip.contrast = 100;
+    strip.static_color_enabled = false;
+    strip.static_r = 0;
+    strip.static_g = 0;
+    strip.static_b = 0;
+    strip.gradient_enabled = false;
+    strip.gradient_count = 0;
+    strip.pulse_color_enabled = false;
+    strip.pulse_r = 0;
+    strip.pulse_g = 0;
+    strip.pulse_b = 0;
+    strip.pulse_speed = 150.0f;
+    strip.pulse_width = 2.0f;
+    strip.pulse_fade = 4.0f;
+    strip.pulse_capacity = DEFAULT_PULSE_CAPACITY;
+    strip.fade_in = 0.0f;
+    strip.fade_out = 0.0f;
+    strip.fade_curve = FADE_LINEAR;
+    strip.onset_weight = 1.0f;
+    strip.onset_sensitivity = DEFAULT_ONSET_SENSITIVITY;
+    strip.lut_max_error = DEFAULT_LUT_MAX_ERROR;
+}
+
+void ResetStrips(StripTransform strips[10]) {
+    for (int i = 0; i < 10; i++) {
+        SetDefaultStrip(strips[i]);
+        BuildPlan(strips[i], StripLedCount[i], StripSectionNames[i]);
+    }
+}
+
+void LoadStrips(StripTransform strips[10], const IniSource& ini) {
+    // Load [global] defaults first
+    StripTransform globalDefaults;
+    SetDefaultStrip(globalDefaults);
+    LoadStripFromSection(globalDefaults, "global", 0, globalDefaults, ini);
+
+    // Load per-strip settings, falling back to [global] values
+    for (int i = 0; i < 10; i++) {
+        LoadStripFromSection(strips[i], StripSectionNames[i], StripLedCount[i], globalDefaults, ini);
+    }
+}
+
+void LoadHookSettings(HookSettings& settings, const IniSource& ini) {
+    settings.asyncTransform = GetIniInt(ini, "hook", "async", 0) != 0;
+    settings.stats = GetIniInt(ini, "hook", "stats", 0) != 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "transform.h"
+
+// Strip section names in the INI file, indexed 0-9
+extern const char* StripSectionNames[10];
+
+// LED count of each strip, indexed 0-9
+extern const int StripLedCount[10];
+
+// Reads one INI value with GetPrivateProfileStringA semantics: copies def into out when the
+// section or key is missing, always NUL-terminates
+typedef void (*IniGetStringFn)(void* ctx, const char* section, const char* key, const char* def,
+                               char* out, int outSize);
+
+// Where LoadStrips reads settings from (the Windows profile API, a parsed file, ...)
+struct IniSource {
+    IniGetStringFn getString;
+    void* ctx;
+};
+
+// Reset a strip's settings to identity (does not rebuild its plan)
+void SetDefaultStrip(StripTransform& strip);
+
+// Reset all strips to identity and rebuild their plans
+void ResetStrips(StripTransform strips[10]);
+
+// Load [global] and then every strip section, falling back to [global] values, and build
+// each strip's plan
+void LoadStrips(StripTransform strips[10], const IniSource& ini);
+
+// Hook-wide settings from the [hook] section, read once when the hook loads
+struct HookSettings {
+    bool asyncTransform;        // async=1: pass the game's data through untouched and transform
+                                // for shared memory on a worker thread
+    bool stats;                 // stats=1: start with latency stats enabled (a reader can
+                                // toggle them later, see stats_protocol.h)
+};
+
+void LoadHookSettings(HookSettings& settings, const IniSource& ini);
@@ -0,0 +1,49 @@
+#include "config_store.h"
+#include "ini_file.h"
+
+StripConfig* BuildStripConfig(const IniFile* ini) {
+    StripConfig* config = new StripConfig();
+    ResetStrips(config->strips);
+    if (ini)
+        LoadStrips(config->strips, MakeIniSource(*ini));
+    return config;
+}
+
+void InitConfigSwap(ConfigSwap& swap, StripConfig* initial) {
+    swap.pending.store(nullptr, std::memory_order_relaxed);
+    swap.retired.store(nullptr, std::memory_order_relaxed);
+    swap.current = initial;
+}
+
+void PublishConfig(ConfigSwap& swap, StripConfig* config) {
+    delete swap.pending.exchange(config, std::memory_order_acq_rel);
+}
+
+void ReclaimConfigs(ConfigSwap& swap) {
+    delete swap.retired.exchange(nullptr, std::memory_order_acquire);
+}
+
+bool ConfigPickedUp(const ConfigSwap& swap) {
+    return swap.pending.load(std::memory_order_acquire) == nullptr;
+}
+
+const StripConfig& AcquireConfig(ConfigSwap& swap) {
+    // A plain load on the common path; the exchange only when something was published and the
+    // loader has freed the config replaced last time (only the reader fills retired, so it
+    // stays empty until the store below)
+    if (swap.pending.load(std::memory_order_relaxed) && !swap.retired.load(std::memory_order_relaxed)) {
+        StripConfig* fresh = swap.pending.exchange(nullptr, std::memory_order_acquire);
+        if (fresh) {
+            swap.retired.store(swap.current, std::memory_order_release);
+            swap.current = fresh;
+        }
+    }
+    return *swap.current;
+}
+
+void DestroyConfigSwap(ConfigSwap& swap) {
+    delete swap.pending.exchange(nullptr, std::memory_order_relaxed);
+    delete swap.retired.exchange(nullptr, std::memory_order_relaxed);
+    delete swap.current;
+    swap.current = nullptr;
+}
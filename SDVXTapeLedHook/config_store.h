@@ -0,0 +1,44 @@
+#pragma once
+#include "config.h"
+#include <atomic>
+
+struct IniFile;
+
+// A complete set of strip settings. Built whole on a loader thread and never modified once
+// published, so the hook never sees a half-updated strip.
+struct StripConfig {
+    StripTransform strips[10];
+};
+
+// Build a config from a parsed INI; nullptr = no file, every strip at identity
+StripConfig* BuildStripConfig(const IniFile* ini);
+
+// Hands configs from one loader thread to one reader (the hook) without locks. The loader
+// publishes a fresh config; the reader picks it up at its next AcquireConfig and hands the one
+// it replaced back through retired, which the loader frees, so the reader never frees memory
+// or waits. While retired is still occupied the reader keeps its current config and leaves
+// the fresh one pending for a later call.
+struct ConfigSwap {
+    std::atomic<StripConfig*> pending;  // published, not yet picked up by the reader
+    std::atomic<StripConfig*> retired;  // replaced by the reader, waiting to be freed
+    StripConfig* current;               // owned by the reader
+};
+
+// Start with an initial config (takes ownership)
+void InitConfigSwap(ConfigSwap& swap, StripConfig* initial);
+
+// Loader side: publish a config (takes ownership). A config published earlier and not picked
+// up yet is dropped.
+void PublishConfig(ConfigSwap& swap, StripConfig* config);
+
+// Loader side: free the configs the reader has replaced
+void ReclaimConfigs(ConfigSwap& swap);
+
+// Loader side: true once the reader has picked up the last published config
+bool ConfigPickedUp(const ConfigSwap& swap);
+
+// Reader side, once per frame: the newest published config, valid until the next call
+const StripConfig& AcquireConfig(ConfigSwap& swap);
+
+// Free everything; neither side may be running
+void DestroyConfigSwap(ConfigSwap& swap);
@@ -0,0 +1,50 @@
+#include "config_watch.h"
+#include "ini_file.h"
+#include <chrono>
+#include <filesystem>
+
+// Write time of the file, or nothing if it does not exist
+static bool GetWriteTime(const std::string& path, std::filesystem::file_time_type& time) {
+    std::error_code ec;
+    time = std::filesystem::last_write_time(path, ec);
+    return !ec;
+}
+
+static void WatchLoop(ConfigWatcher& watcher, ConfigSwap& swap, std::string path, int pollMs) {
+    std::filesystem::file_time_type lastWrite;
+    bool existed = GetWriteTime(path, lastWrite);
+
+    std::unique_lock<std::mutex> lock(watcher.mutex);
+    while (!watcher.wake.wait_for(lock, std::chrono::milliseconds(pollMs), [&] { return watcher.stop; })) {
+        ReclaimConfigs(swap);
+
+        std::filesystem::file_time_type writeTime;
+        bool exists = GetWriteTime(path, writeTime);
+        if (exists == existed && (!exists || writeTime == lastWrite))
+            continue;
+        existed = exists;
+        lastWrite = writeTime;
+
+        // File deleted = every strip back to identity, as if it had never existed
+        IniFile ini;
+        bool loaded = exists && LoadIniFile(ini, path.c_str());
+        PublishConfig(swap, BuildStripConfig(loaded ? &ini : nullptr));
+        watcher.reloads++;
+    }
+}
+
+void StartConfigWatcher(ConfigWatcher& watcher, ConfigSwap& swap, const std::string& path, int pollMs) {
+    watcher.stop = false;
+    watcher.reloads = 0;
+    watcher.thread = std::thread(WatchLoop, std::ref(watcher), std::ref(swap), path, pollMs);
+}
+
+void StopConfigWatcher(ConfigWatcher& watcher) {
+    {
+        std::lock_guard<std::mutex> lock(watcher.mutex);
+        watcher.stop = true;
+    }
+    watcher.wake.notify_one();
+    if (watcher.thread.joinable())
+        watcher.thread.join();
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "config_store.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Polling INI watcher for the portable build: a background thread checks the file's write time
+// every pollMs and publishes a freshly loaded config to a ConfigSwap when it changes. The hook
+// DLL watches with ReadDirectoryChangesW instead (config_win.cpp).
+struct ConfigWatcher {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop;
+    std::atomic<int> reloads;           // configs published since Start
+};
+
+// Start watching path; the swap must outlive the watcher
+void StartConfigWatcher(ConfigWatcher& watcher, ConfigSwap& swap, const std::string& path, int pollMs);
+
+// Stop and join the thread
+void StopConfigWatcher(ConfigWatcher& watcher);
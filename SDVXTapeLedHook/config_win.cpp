@@ -0,0 +1,190 @@
+#include "config_win.h"
+#include "ini_file.h"
+#include "transform_simd.h"
+#include <string>
+
+// Wait after a change notification so an editor's multi-step save has settled before reading
+static constexpr DWORD DEBOUNCE_MS = 100;
+
+// Write time check interval when no notification arrives (and the only check if the directory
+// cannot be watched, e.g. on some network drives)
+static constexpr DWORD RESCAN_INTERVAL_MS = 3000;
+
+// After publishing, how often and how long to wait for the hook to pick the config up, so the
+// one it replaced is freed then instead of at the next wakeup (the hook takes a new config only
+// once the previous replaced one is freed). A game that is not running frames gives up the wait.
+static constexpr DWORD PICKUP_POLL_MS = 5;
+static constexpr int PICKUP_POLLS = 200;
+
+static void LogToDebugger(const char* message) {
+    OutputDebugStringA(message);
+}
+
+// Last write time of the INI; false if it does not exist
+static bool GetIniWriteTime(const TransformConfig& config, FILETIME& writeTime) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(config.iniPath, GetFileExInfoStandard, &data))
+        return false;
+    writeTime = data.ftLastWriteTime;
+    return true;
+}
+
+// Read and parse the whole INI with one open; false if it cannot be opened
+static bool ReadIni(const TransformConfig& config, IniFile& ini) {
+    HANDLE hFile = CreateFileW(config.iniPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                               nullptr, OPEN_EXISTING, 0, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    std::string text;
+    char buf[4096];
+    DWORD read;
+    while (ReadFile(hFile, buf, sizeof(buf), &read, nullptr) && read > 0)
+        text.append(buf, read);
+    CloseHandle(hFile);
+
+    ParseIniText(ini, text.data(), text.size());
+    return true;
+}
+
+// Build a config from the INI as it is now (identity if there is none)
+static StripConfig* ReadConfig(TransformConfig& config) {
+    IniFile ini;
+    FILETIME writeTime = {};
+    bool loaded = GetIniWriteTime(config, writeTime) && ReadIni(config, ini);
+    config.lastWriteTime = loaded ? writeTime : FILETIME{};
+    return BuildStripConfig(loaded ? &ini : nullptr);
+}
+
+void InitConfig(TransformConfig& config, HMODULE hModule) {
+    // Pick the vectorized strip kernels for this CPU; diagnostics go to the debugger
+    InitSimd();
+    SetTransformLog(LogToDebugger);
+
+    // Resolve INI path: same directory as the DLL
+    wchar_t dllPath[MAX_PATH];
+    GetModuleFileNameW(hModule, dllPath, MAX_PATH);
+    // Find last backslash and replace filename
+    wchar_t* lastSlash = wcsrchr(dllPath, L'\\');
+    if (lastSlash) {
+        *(lastSlash + 1) = L'\0';
+    }
+    wcscpy_s(config.iniDir, dllPath);
+    wcscpy_s(config.iniPath, dllPath);
+    wcscat_s(config.iniPath, L"sdvxrgb.ini");
+
+    config.lastWriteTime = {};
+    config.watcherThread = nullptr;
+    config.stopEvent = nullptr;
+
+    // Identity defaults for all strips until the INI is loaded
+    InitConfigSwap(config.swap, BuildStripConfig(nullptr));
+}
+
+void LoadConfig(TransformConfig& config) {
+    // Only the hook settings: building the strips can take seconds (3D LUT error scans) and
+    // this runs under the loader lock. lastWriteTime stays zero, so the watcher thread builds
+    // and publishes them first thing.
+    IniFile ini;
+    ReadIni(config, ini);
+    LoadHookSettings(config.hook, MakeIniSource(ini));
+}
+
+// Reload if the INI's write time changed or it appeared/disappeared
+static void ReloadIfChanged(TransformConfig& config) {
+    FILETIME writeTime = {};
+    GetIniWriteTime(config, writeTime);
+    if (CompareFileTime(&writeTime, &config.lastWriteTime) != 0) {
+        PublishConfig(config.swap, ReadConfig(config));
+        for (int i = 0; i < PICKUP_POLLS && !ConfigPickedUp(config.swap); i++) {
+            if (WaitForSingleObject(config.stopEvent, PICKUP_POLL_MS) == WAIT_OBJECT_0)
+                break;
+        }
+    }
+    ReclaimConfigs(config.swap);
+}
+
+// True if a change notification buffer mentions the INI (or overflowed and may have)
+static bool MentionsIni(const BYTE* buffer, DWORD bytes) {
+    if (bytes == 0)
+        return true;
+    for (;;) {
+        const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer);
+        int length = static_cast<int>(info->FileNameLength / sizeof(wchar_t));
+        if (CompareStringOrdinal(info->FileName, length, L"sdvxrgb.ini", -1, TRUE) == CSTR_EQUAL)
+            return true;
+        if (info->NextEntryOffset == 0)
+            return false;
+        buffer += info->NextEntryOffset;
+    }
+}
+
+static DWORD WINAPI WatcherThread(LPVOID param) {
+    TransformConfig& config = *static_cast<TransformConfig*>(param);
+
+    HANDLE hDir = CreateFileW(config.iniDir, FILE_LIST_DIRECTORY,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    DWORD buffer[1024];     // FILE_NOTIFY_INFORMATION needs DWORD alignment
+    bool pending = false;
+
+    // The first build, left here by LoadConfig
+    ReloadIfChanged(config);
+
+    for (;;) {
+        if (!pending && hDir != INVALID_HANDLE_VALUE && overlapped.hEvent) {
+            pending = ReadDirectoryChangesW(hDir, buffer, sizeof(buffer), FALSE,
+                                            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                                            FILE_NOTIFY_CHANGE_SIZE, nullptr, &overlapped, nullptr) != 0;
+        }
+
+        HANDLE handles[2] = { config.stopEvent, overlapped.hEvent };
+        DWORD wait = WaitForMultipleObjects(pending ? 2 : 1, handles, FALSE, RESCAN_INTERVAL_MS);
+        if (wait == WAIT_OBJECT_0)
+            break;
+
+        if (wait == WAIT_OBJECT_0 + 1) {
+            DWORD bytes = 0;
+            GetOverlappedResult(hDir, &overlapped, &bytes, FALSE);
+            ResetEvent(overlapped.hEvent);
+            pending = false;
+            if (!MentionsIni(reinterpret_cast<const BYTE*>(buffer), bytes))
+                continue;
+            if (WaitForSingleObject(config.stopEvent, DEBOUNCE_MS) == WAIT_OBJECT_0)
+                break;
+        }
+        ReloadIfChanged(config);
+    }
+
+    if (pending) {
+        CancelIo(hDir);
+        DWORD bytes;
+        GetOverlappedResult(hDir, &overlapped, &bytes, TRUE);
+    }
+    if (overlapped.hEvent)
+        CloseHandle(overlapped.hEvent);
+    if (hDir != INVALID_HANDLE_VALUE)
+        CloseHandle(hDir);
+    return 0;
+}
+
+void StartConfigWatcher(TransformConfig& config) {
+    config.stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!config.stopEvent)
+        return;
+    config.watcherThread = CreateThread(nullptr, 0, WatcherThread, &config, 0, nullptr);
+}
+
+void StopConfigWatcher(TransformConfig& config) {
+    // The thread cannot be joined under the loader lock; it exits at its next wakeup. DllMain
+    // pins the module (GET_MODULE_HANDLE_EX_FLAG_PIN) before starting it, so it never runs
+    // unmapped code, and stopEvent is left open for it to see.
+    if (config.stopEvent)
+        SetEvent(config.stopEvent);
+    if (config.watcherThread) {
+        CloseHandle(config.watcherThread);
+        config.watcherThread = nullptr;
+    }
+}
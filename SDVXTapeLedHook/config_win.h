@@ -0,0 +1,29 @@
+#pragma once
+#define NOMINMAX
+#include <Windows.h>
+#include "config_store.h"
+
+struct TransformConfig {
+    ConfigSwap swap;            // strips the hook reads, replaced whole by the watcher thread
+    HookSettings hook;          // from LoadConfig only: changes need a restart
+    wchar_t iniPath[MAX_PATH];
+    wchar_t iniDir[MAX_PATH];
+    FILETIME lastWriteTime;     // of the loaded file, zero if there was none (watcher thread only)
+    HANDLE watcherThread;
+    HANDLE stopEvent;
+};
+
+// Initialize config with identity defaults and resolve INI path
+void InitConfig(TransformConfig& config, HMODULE hModule);
+
+// Read the hook settings from the INI (synchronously, before the watcher starts). The strips
+// stay at identity until the watcher thread has built them from the INI.
+void LoadConfig(TransformConfig& config);
+
+// Start the thread that builds the strips from the INI and reloads it when it changes. The hook
+// only calls AcquireConfig.
+void StartConfigWatcher(TransformConfig& config);
+
+// Tell the watcher thread to exit (does not wait: called from DllMain under the loader lock;
+// safe because DllMain pins the module before starting the thread)
+void StopConfigWatcher(TransformConfig& config);
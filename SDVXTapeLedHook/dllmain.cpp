@@ -1,39 +1,87 @@
 ﻿#include <Windows.h>
 #include <MinHook.h>
+#include <atomic>
 #include <cstdint>
-#include "transform.h"
-
-// shared memory
+#include <cstdio>
+#include "async_frame.h"
+#include "config_win.h"
+#include "frame.h"
+#include "shm_protocol.h"
+#include "stats_protocol.h"
+
+// shared memory: legacy bare frame and the v2 seqlocked frame (see shm_protocol.h)
 HANDLE hMapFile;
 uint8_t* lpBase = nullptr;
+HANDLE hMapFileV2;
+ShmFrameV2* g_shmV2 = nullptr;
+HANDLE g_frameEvents[SHM_EVENT_SLOTS];     // signaled after each v2 frame, one per consumer slot
 
-// transform config (loaded from sdvxrgb.ini next to the DLL)
+// transform config (loaded from sdvxrgb.ini next to the DLL, reloaded by a watcher thread)
 TransformConfig g_transformConfig;
 HMODULE g_hModule = nullptr;
 
-// Fade state for smooth LED activation/deactivation transitions
-static constexpr int MAX_LEDS = 94; // largest strip: ctrl_panel = 94 LEDs
-struct StripFadeState {
-    float factor[MAX_LEDS];          // current fade factor per LED (0.0-1.0)
-    uint8_t lastColor[MAX_LEDS * 3]; // last non-zero color (for fade-out)
-    bool initialized;
-    LARGE_INTEGER lastTime;
-};
-
-static StripFadeState g_fadeState[10] = {};
-
-// Pulse state for beat-triggered traveling pulses (multiple per strip)
-struct StripPulseState {
-    bool seeded;                        // has prevBrightness been initialized?
-    float prevBrightness;               // average brightness of previous frame
-    LARGE_INTEGER lastTime;             // QPC timestamp of last update
-    int pulseCount;                     // number of active pulses
-    float positions[MAX_PULSES];        // position of each active pulse
-};
-
-static StripPulseState g_pulseState[10] = {};
+// Frame being assembled from the game's per-strip calls
+static uint8_t g_frameIn[FRAME_BYTES];
+static uint8_t g_frameOut[FRAME_BYTES];
+static uint16_t g_pendingStrips = 0;      // bit i = strip i received since the last flush
+static void* g_pendingThis[10];           // object each pending strip was set on
+static LARGE_INTEGER g_pendingSince = {}; // when the first pending strip arrived
+static uint16_t g_frameStrips = ALL_STRIPS;   // strips in the game's last frame; a frame is
+                                              // complete once they are all pending
+
+// A partial frame older than this is flushed before the next strip joins it, so strips held
+// over a pause or scene change go out with the game's next call instead of a later frame
+static constexpr int64_t PENDING_MAX_US = 5000;
+static int64_t g_pendingMaxTicks = 0;
+
+// Fade and pulse state of every strip, and the frame clock driving them (owned by the thread
+// that transforms: the game thread, or the worker in async mode). The clock reads QPC through
+// g_timeSource once per frame.
+static FrameState g_frameState = {};
+static FrameClock g_frameClock = {};
+static TimeSource g_timeSource = {};
 static LARGE_INTEGER g_qpcFreq = {};
-static constexpr float BEAT_THRESHOLD = 15.0f;
+
+// Async mode ([hook] async=1): the game thread queues the raw frames and passes its data through
+// untouched; a worker thread transforms and publishes them
+static bool g_async = false;
+static AsyncFrameQueue g_asyncQueue;
+static AsyncProducer g_asyncProducer;
+static HANDLE g_asyncWake = NULL;         // auto-reset, set when a frame is queued
+static HANDLE g_asyncThread = NULL;
+static std::atomic<bool> g_asyncStop(false);
+
+// Metrics, logged to the debugger every STATS_LOG_FRAMES frames
+static constexpr uint64_t STATS_LOG_FRAMES = 3600;
+static int64_t g_hookTicks = 0;           // game-thread time in the hook, original function excluded
+static uint64_t g_hookFrames = 0;         // frames flushed (sync) or queued (async)
+static std::atomic<int64_t> g_latencyTicks(0);    // worker: queued -> published, summed
+static std::atomic<int64_t> g_latencyMaxTicks(0);
+static std::atomic<uint64_t> g_workerFrames(0);
+
+// Latency histograms in the "sdvxrgb_stats" mapping (see stats_protocol.h), filled while a
+// reader or [hook] stats enables them. The stats clock is calibrated against QPC every
+// STATS_CALIBRATE_FRAMES frames, from the pair of readings taken at attach.
+static constexpr uint64_t STATS_CALIBRATE_FRAMES = 128;
+HANDLE hMapFileStats;
+StatsBlock* g_stats = nullptr;
+static uint64_t g_statsStartTicks = 0;
+static LARGE_INTEGER g_statsStartQpc = {};
+
+// QPC ticks to seconds for the frame clock
+static double QpcSeconds(LARGE_INTEGER ticks) {
+    return static_cast<double>(ticks.QuadPart) / static_cast<double>(g_qpcFreq.QuadPart);
+}
+
+static double QpcNow(void*) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return QpcSeconds(now);
+}
+
+static double TicksToMicroseconds(int64_t ticks) {
+    return ticks * 1e6 / static_cast<double>(g_qpcFreq.QuadPart);
+}
 
 /*
 * index mapping
@@ -53,162 +101,220 @@ static constexpr float BEAT_THRESHOLD = 15.0f;
 *
 */
 
-// Offset and count of each tape led data in shared memory
-int TapeLedDataOffset[10] = { 0 * 3, 74 * 3, 86 * 3, 98 * 3, 154 * 3, 210 * 3, 304 * 3, 316 * 3, 328 * 3, 342 * 3 };
-int TapeLedDataCount[10] = { 74 * 3, 12 * 3, 12 * 3, 56 * 3, 56 * 3, 94 * 3, 12 * 3, 12 * 3, 14 * 3, 86 * 3 };
-
 // Define original function
 typedef void(__fastcall* SetTapeLedData_t)(void* This, unsigned int index, uint8_t* data);
 
 // Save original function pointer
 SetTapeLedData_t fpOriginal = nullptr;
 
-// Hook function
-void __fastcall SetTapeLedDataHook(void* This, unsigned int index, uint8_t* data) {
-    if (index < 10) {
-        // Check for config hot-reload
-        CheckReload(g_transformConfig);
+// Write g_frameOut to shared memory and wake its readers
+static void PublishFrame(LARGE_INTEGER now) {
+    if (lpBase) {
+        memcpy(lpBase, g_frameOut, FRAME_BYTES);
+    }
+    if (g_shmV2) {
+        // Strips whose output differs from the last published frame
+        uint32_t dirty = 0;
+        for (int i = 0; i < 10; i++) {
+            if (memcmp(g_shmV2->rgb + StripByteOffset[i], g_frameOut + StripByteOffset[i],
+                       StripLedCount[i] * 3) != 0)
+                dirty |= 1u << i;
+        }
+        PublishShmV2(g_shmV2, g_frameOut, dirty, now.QuadPart);
 
-        const StripTransform& strip = g_transformConfig.strips[index];
-        int count = TapeLedDataCount[index];
-        int numLEDs = count / 3;
+        // Wake the consumers blocked on the frame
+        for (int i = 0; i < SHM_EVENT_SLOTS; i++) {
+            if (g_frameEvents[i])
+                SetEvent(g_frameEvents[i]);
+        }
+    }
+}
 
-        // Beat detection and pulse update
-        PulseRender pulse = {};
-        if (strip.pulse_color_enabled) {
-            StripPulseState& ps = g_pulseState[index];
+// The stats block while instrumentation is on, else nullptr
+static StatsBlock* ActiveStats() {
+    return g_stats && g_stats->enabled.load(std::memory_order_relaxed) ? g_stats : nullptr;
+}
 
-            // Compute average brightness of raw incoming data
-            int sum = 0;
-            for (int i = 0; i < count; i++)
-                sum += data[i];
-            float avgBrightness = static_cast<float>(sum) / static_cast<float>(count);
+// Close a frame's stats (thread that publishes): the publish stage from publishStart, the
+// whole pass from passStart, the frame count and the clock calibration
+static void EndStatsFrame(StatsBlock& stats, uint64_t passStart, uint64_t publishStart, LARGE_INTEGER now) {
+    uint64_t end = StatsTimestamp();
+    RecordStats(stats.frame[STATS_FRAME_PUBLISH], end - publishStart);
+    RecordStats(stats.frame[STATS_FRAME_PASS], end - passStart);
+
+    int64_t elapsed = now.QuadPart - g_statsStartQpc.QuadPart;
+    if ((++stats.frames % STATS_CALIBRATE_FRAMES == 0 || stats.ticksPerSecond == 0) && elapsed > 0) {
+        stats.ticksPerSecond = static_cast<int64_t>(static_cast<double>(end - g_statsStartTicks) *
+                                                    g_qpcFreq.QuadPart / elapsed);
+    }
+}
 
-            LARGE_INTEGER now;
-            QueryPerformanceCounter(&now);
+// Close a hook call's stats (game thread): its time without the excluded original calls
+static void EndStatsCall(StatsBlock& stats, unsigned int index, uint64_t start, uint64_t excluded) {
+    stats.strips[index].calls++;
+    RecordStats(stats.strips[index].stages[STATS_STAGE_HOOK], StatsTimestamp() - start - excluded);
+}
 
-            if (!ps.seeded) {
-                // First call — seed brightness, don't trigger
-                ps.prevBrightness = avgBrightness;
-                ps.lastTime = now;
-                ps.seeded = true;
-            } else {
-                // Compute elapsed time
-                float elapsed = static_cast<float>(now.QuadPart - ps.lastTime.QuadPart)
-                              / static_cast<float>(g_qpcFreq.QuadPart);
-                if (elapsed > 0.1f) elapsed = 0.1f; // clamp to 100ms
-                ps.lastTime = now;
-
-                // Advance all active pulses and remove finished ones
-                float limit = static_cast<float>(numLEDs);
-                int write = 0;
-                for (int j = 0; j < ps.pulseCount; j++) {
-                    ps.positions[j] += strip.pulse_speed * elapsed;
-                    if (ps.positions[j] < limit) {
-                        ps.positions[write++] = ps.positions[j];
-                    }
-                }
-                ps.pulseCount = write;
-
-                // Check for beat: brightness rising above threshold
-                float delta = avgBrightness - ps.prevBrightness;
-                if (delta > BEAT_THRESHOLD && ps.pulseCount < MAX_PULSES) {
-                    ps.positions[ps.pulseCount++] = 0.0f;
-                }
-
-                ps.prevBrightness = avgBrightness;
-            }
+// Hand a strip to the game. Returns the ticks it took when timed, else 0.
+static uint64_t CallOriginal(void* This, unsigned int index, uint8_t* data, StatsBlock* stats) {
+    if (!stats) {
+        fpOriginal(This, index, data);
+        return 0;
+    }
+    uint64_t start = StatsTimestamp();
+    fpOriginal(This, index, data);
+    uint64_t ticks = StatsTimestamp() - start;
+    RecordStats(stats->strips[index].stages[STATS_STAGE_ORIGINAL], ticks);
+    return ticks;
+}
 
-            // Build render info
-            if (ps.pulseCount > 0) {
-                pulse.count = ps.pulseCount;
-                for (int j = 0; j < ps.pulseCount; j++)
-                    pulse.positions[j] = ps.positions[j];
-                pulse.width = strip.pulse_width;
-                pulse.fade = strip.pulse_fade;
-                pulse.r = strip.pulse_r;
-                pulse.g = strip.pulse_g;
-                pulse.b = strip.pulse_b;
-            }
-        }
+// Log the metrics of the last STATS_LOG_FRAMES frames (game thread)
+static void CountFrame() {
+    if (++g_hookFrames % STATS_LOG_FRAMES != 0)
+        return;
 
-        // Copy strip data to a local buffer and apply transforms
-        uint8_t transformed[282]; // largest strip: ctrl_panel = 94 * 3 = 282
-        memcpy(transformed, data, count);
-        TransformStrip(strip, transformed, count, pulse);
+    char message[256];
+    double hookUs = TicksToMicroseconds(g_hookTicks) / STATS_LOG_FRAMES;
+    if (g_async) {
+        uint64_t done = g_workerFrames.exchange(0, std::memory_order_relaxed);
+        int64_t latency = g_latencyTicks.exchange(0, std::memory_order_relaxed);
+        int64_t latencyMax = g_latencyMaxTicks.exchange(0, std::memory_order_relaxed);
+        snprintf(message, sizeof(message),
+                 "sdvxrgb: hook %.2f us/frame (async), queue max depth %u, %llu dropped, "
+                 "latency avg %.1f us max %.1f us\n",
+                 hookUs, g_asyncProducer.maxDepth, static_cast<unsigned long long>(g_asyncProducer.dropped),
+                 done ? TicksToMicroseconds(latency) / done : 0.0, TicksToMicroseconds(latencyMax));
+        g_asyncProducer.maxDepth = 0;
+    } else {
+        snprintf(message, sizeof(message), "sdvxrgb: hook %.2f us/frame (sync)\n", hookUs);
+    }
+    OutputDebugStringA(message);
+    g_hookTicks = 0;
+}
 
-        // Apply fade in/out if configured
-        if (strip.fade_in > 0.0f || strip.fade_out > 0.0f) {
-            StripFadeState& fs = g_fadeState[index];
+// Transform the strips received since the last flush in one pass and hand them to the game.
+// start = when the hook's own work began; it is moved past the original function's calls.
+// Returns the stats ticks spent in the original function (0 without stats).
+static uint64_t FlushFrame(LARGE_INTEGER& start, StatsBlock* stats) {
+    // Newest config from the watcher thread (hot-reload never touches the filesystem here)
+    uint64_t passStart = stats ? StatsTimestamp() : 0;
+    uint64_t lap = passStart;
+    const StripConfig& config = AcquireConfig(g_transformConfig.swap);
+    if (stats)
+        StatsLap(stats->frame[STATS_FRAME_CONFIG], lap);
+
+    TickFrameClock(g_frameClock, g_timeSource);
+    TransformFrame(config.strips, g_frameState, g_frameIn, g_frameOut, g_frameClock,
+                   g_pendingStrips, stats ? stats->strips : nullptr);
+
+    // Write transformed data to shared memory (strips not received keep their last output)
+    if (stats)
+        lap = StatsTimestamp();
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    PublishFrame(now);
+    if (stats)
+        EndStatsFrame(*stats, passStart, lap, now);
+
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+    g_hookTicks += end.QuadPart - start.QuadPart;
+    CountFrame();
+
+    // Pass transformed data to original function
+    uint64_t originalTicks = 0;
+    for (unsigned int i = 0; i < 10; i++) {
+        if (g_pendingStrips & (1 << i))
+            originalTicks += CallOriginal(g_pendingThis[i], i, g_frameOut + StripByteOffset[i], stats);
+    }
+    g_pendingStrips = 0;
+    QueryPerformanceCounter(&start);
+    return originalTicks;
+}
 
+// Async mode worker: transform and publish queued frames as they arrive
+static DWORD WINAPI AsyncWorkerThread(LPVOID) {
+    while (WaitForSingleObject(g_asyncWake, INFINITE) == WAIT_OBJECT_0 &&
+           !g_asyncStop.load(std::memory_order_relaxed)) {
+        while (AsyncFrame* frame = g_asyncQueue.Front()) {
+            StatsBlock* stats = ActiveStats();
+            uint64_t passStart = stats ? StatsTimestamp() : 0;
+            uint64_t lap = passStart;
+            const StripConfig& config = AcquireConfig(g_transformConfig.swap);
+            if (stats)
+                StatsLap(stats->frame[STATS_FRAME_CONFIG], lap);
+            TickFrameClock(g_frameClock, frame->time);
+            TransformFrame(config.strips, g_frameState, frame->rgb, g_frameOut, g_frameClock,
+                           frame->strips, stats ? stats->strips : nullptr);
+
+            if (stats)
+                lap = StatsTimestamp();
             LARGE_INTEGER now;
             QueryPerformanceCounter(&now);
+            PublishFrame(now);
+            if (stats)
+                EndStatsFrame(*stats, passStart, lap, now);
+
+            int64_t latency = static_cast<int64_t>((QpcSeconds(now) - frame->time) * g_qpcFreq.QuadPart);
+            g_latencyTicks.fetch_add(latency, std::memory_order_relaxed);
+            if (latency > g_latencyMaxTicks.load(std::memory_order_relaxed))
+                g_latencyMaxTicks.store(latency, std::memory_order_relaxed);
+            g_workerFrames.fetch_add(1, std::memory_order_relaxed);
+            g_asyncQueue.Pop();
+        }
+    }
+    return 0;
+}
 
-            if (!fs.initialized) {
-                // First call — initialize all factors based on current state
-                for (int i = 0; i < numLEDs; i++) {
-                    int idx = i * 3;
-                    bool active = (transformed[idx] | transformed[idx + 1] | transformed[idx + 2]) != 0;
-                    fs.factor[i] = active ? 1.0f : 0.0f;
-                    fs.lastColor[idx] = transformed[idx];
-                    fs.lastColor[idx + 1] = transformed[idx + 1];
-                    fs.lastColor[idx + 2] = transformed[idx + 2];
-                }
-                fs.lastTime = now;
-                fs.initialized = true;
-            } else {
-                float elapsed = static_cast<float>(now.QuadPart - fs.lastTime.QuadPart)
-                              / static_cast<float>(g_qpcFreq.QuadPart);
-                if (elapsed > 0.1f) elapsed = 0.1f; // clamp to 100ms
-                fs.lastTime = now;
-
-                for (int i = 0; i < numLEDs; i++) {
-                    int idx = i * 3;
-                    bool active = (transformed[idx] | transformed[idx + 1] | transformed[idx + 2]) != 0;
-
-                    if (active) {
-                        // Save the current color for potential future fade-out
-                        fs.lastColor[idx] = transformed[idx];
-                        fs.lastColor[idx + 1] = transformed[idx + 1];
-                        fs.lastColor[idx + 2] = transformed[idx + 2];
-
-                        // Ramp factor toward 1.0
-                        if (strip.fade_in > 0.0f && fs.factor[i] < 1.0f) {
-                            fs.factor[i] += (elapsed * 1000.0f) / strip.fade_in;
-                            if (fs.factor[i] > 1.0f) fs.factor[i] = 1.0f;
-                        } else {
-                            fs.factor[i] = 1.0f;
-                        }
-
-                        // Apply fade factor to the transformed color
-                        transformed[idx]     = static_cast<uint8_t>(transformed[idx]     * fs.factor[i]);
-                        transformed[idx + 1] = static_cast<uint8_t>(transformed[idx + 1] * fs.factor[i]);
-                        transformed[idx + 2] = static_cast<uint8_t>(transformed[idx + 2] * fs.factor[i]);
-                    } else {
-                        // Ramp factor toward 0.0
-                        if (strip.fade_out > 0.0f && fs.factor[i] > 0.0f) {
-                            fs.factor[i] -= (elapsed * 1000.0f) / strip.fade_out;
-                            if (fs.factor[i] < 0.0f) fs.factor[i] = 0.0f;
-                        } else {
-                            fs.factor[i] = 0.0f;
-                        }
-
-                        // Output last known color scaled by fade factor
-                        transformed[idx]     = static_cast<uint8_t>(fs.lastColor[idx]     * fs.factor[i]);
-                        transformed[idx + 1] = static_cast<uint8_t>(fs.lastColor[idx + 1] * fs.factor[i]);
-                        transformed[idx + 2] = static_cast<uint8_t>(fs.lastColor[idx + 2] * fs.factor[i]);
-                    }
-                }
+// Hook function
+void __fastcall SetTapeLedDataHook(void* This, unsigned int index, uint8_t* data) {
+    if (index < 10) {
+        // While stats are off this costs one load, then a branch per stage
+        StatsBlock* stats = ActiveStats();
+        uint64_t statsStart = stats ? StatsTimestamp() : 0;
+        uint64_t originalTicks = 0;
+        LARGE_INTEGER start, end;
+        QueryPerformanceCounter(&start);
+
+        if (g_async) {
+            // One copy for the worker, then the game gets its own data untouched
+            if (PushAsyncStrip(g_asyncQueue, g_asyncProducer, index, data, g_timeSource)) {
+                SetEvent(g_asyncWake);
+                CountFrame();
             }
+            QueryPerformanceCounter(&end);
+            g_hookTicks += end.QuadPart - start.QuadPart;
+            if (stats)
+                EndStatsCall(*stats, index, statsStart, 0);
+            CallOriginal(This, index, data, stats);
+            return;
         }
 
-        // Write transformed data to shared memory
-        if (lpBase) {
-            memcpy(lpBase + TapeLedDataOffset[index], transformed, count);
+        // The game sends a frame's strips in index order: a strip arriving again, or below one
+        // already received, starts a new frame. Flush the partial one first, and remember
+        // which strips the game's frames have so the next one goes out without waiting for
+        // strips it never sends. A partial frame that waited too long is flushed as well.
+        if (g_pendingStrips) {
+            bool newFrame = (g_pendingStrips >> index) != 0;
+            if (newFrame)
+                g_frameStrips = g_pendingStrips;
+            if (newFrame || start.QuadPart - g_pendingSince.QuadPart > g_pendingMaxTicks)
+                originalTicks += FlushFrame(start, stats);
         }
+        if (!g_pendingStrips)
+            g_pendingSince = start;
+
+        memcpy(g_frameIn + StripByteOffset[index], data, StripLedCount[index] * 3);
+        g_pendingThis[index] = This;
+        g_pendingStrips |= 1 << index;
+
+        if (g_pendingStrips == ALL_STRIPS || g_pendingStrips == g_frameStrips)
+            originalTicks += FlushFrame(start, stats);
 
-        // Pass transformed data to original function
-        fpOriginal(This, index, transformed);
+        QueryPerformanceCounter(&end);
+        g_hookTicks += end.QuadPart - start.QuadPart;
+        if (stats)
+            EndStatsCall(*stats, index, statsStart, originalTicks);
         return;
     }
 
@@ -221,6 +327,13 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
     case DLL_PROCESS_ATTACH: {
         g_hModule = hModule;
 
+        // Init QPC frequency and start the frame clock for pulse/fade timing before anything can
+        // run a frame: the hook's first FlushFrame reads g_timeSource
+        QueryPerformanceFrequency(&g_qpcFreq);
+        g_pendingMaxTicks = g_qpcFreq.QuadPart * PENDING_MAX_US / 1000000;
+        g_timeSource.now = QpcNow;
+        g_frameClock = StartFrameClock(g_timeSource);
+
         // Init MinHook
         if (MH_Initialize() != MH_OK) {
             return FALSE;
@@ -239,14 +352,12 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
             return FALSE;
         }
 
-        // Create Hook
-        if (MH_CreateHook(pTarget, &SetTapeLedDataHook,
-            reinterpret_cast<void**>(&fpOriginal)) != MH_OK) {
-            return FALSE;
-        }
-
-        // Enable Hook
-        if (MH_EnableHook(pTarget) != MH_OK) {
+        // Pin the module before starting any thread: the config watcher and the async worker
+        // cannot be joined in DllMain, so FreeLibrary must never unmap the code they run. Detach
+        // then only comes at process exit or after a failed attach.
+        HMODULE hPinned;
+        if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN,
+                                reinterpret_cast<LPCWSTR>(&DllMain), &hPinned)) {
             return FALSE;
         }
 
@@ -272,13 +383,98 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
         // Init transform config from sdvxrgb.ini
         InitConfig(g_transformConfig, hModule);
         LoadConfig(g_transformConfig);
+        StartConfigWatcher(g_transformConfig);
 
-        // Init QPC frequency for pulse timing
-        QueryPerformanceFrequency(&g_qpcFreq);
+        // Init v2 shared memory (header + seqlocked frame)
+        hMapFileV2 = CreateFileMappingA(
+            INVALID_HANDLE_VALUE,
+            NULL,
+            PAGE_READWRITE,
+            0,
+            sizeof(ShmFrameV2),
+            SHM_V2_NAME
+        );
+        if (hMapFileV2) {
+            g_shmV2 = static_cast<ShmFrameV2*>(MapViewOfFile(
+                hMapFileV2,
+                FILE_MAP_ALL_ACCESS,
+                0,
+                0,
+                sizeof(ShmFrameV2)
+            ));
+            if (g_shmV2) {
+                InitShmV2(g_shmV2, StripByteOffset, StripLedCount, 10, g_qpcFreq.QuadPart);
+            }
+        }
+
+        // Init the stats mapping (instrumentation stays off unless [hook] stats=1 or a reader
+        // enables it)
+        g_statsStartTicks = StatsTimestamp();
+        QueryPerformanceCounter(&g_statsStartQpc);
+        hMapFileStats = CreateFileMappingA(
+            INVALID_HANDLE_VALUE,
+            NULL,
+            PAGE_READWRITE,
+            0,
+            sizeof(StatsBlock),
+            STATS_SHM_NAME
+        );
+        if (hMapFileStats) {
+            g_stats = static_cast<StatsBlock*>(MapViewOfFile(
+                hMapFileStats,
+                FILE_MAP_ALL_ACCESS,
+                0,
+                0,
+                sizeof(StatsBlock)
+            ));
+            if (g_stats) {
+                InitStatsBlock(g_stats, 10, 0, g_transformConfig.hook.stats);
+            }
+        }
+
+        // Init frame-ready events (auto-reset, initially clear)
+        for (int i = 0; i < SHM_EVENT_SLOTS; i++) {
+            g_frameEvents[i] = CreateEventA(NULL, FALSE, FALSE, SHM_EVENT_NAMES[i]);
+        }
+
+        // Start the transform worker in async mode (sync mode if it cannot start)
+        if (g_transformConfig.hook.asyncTransform) {
+            g_asyncWake = CreateEventA(NULL, FALSE, FALSE, NULL);
+            if (g_asyncWake)
+                g_asyncThread = CreateThread(NULL, 0, AsyncWorkerThread, NULL, 0, NULL);
+            g_async = g_asyncThread != NULL;
+        }
+
+        // Create and enable the hook last: a SetTapeLedData call may arrive as soon as it is
+        // enabled and uses the config, the time source, the mappings and the events above
+        if (MH_CreateHook(pTarget, &SetTapeLedDataHook,
+            reinterpret_cast<void**>(&fpOriginal)) != MH_OK) {
+            return FALSE;
+        }
+        if (MH_EnableHook(pTarget) != MH_OK) {
+            return FALSE;
+        }
 
         break;
     }
     case DLL_PROCESS_DETACH: {
+        // Stop reloading the INI and the async worker. Neither can be joined under the loader
+        // lock: at process exit (lpReserved != nullptr) they are already gone; after a failed
+        // attach they may still be running, so everything they touch stays (the module is
+        // pinned, their code stays mapped too).
+        StopConfigWatcher(g_transformConfig);
+        if (g_asyncThread) {
+            g_async = false;
+            g_asyncStop.store(true, std::memory_order_relaxed);
+            SetEvent(g_asyncWake);
+            CloseHandle(g_asyncThread);
+            g_asyncThread = NULL;
+        }
+        if (lpReserved == nullptr) {
+            MH_DisableHook(MH_ALL_HOOKS);
+            break;
+        }
+
         // Clean up shared memory
         if (lpBase) {
             UnmapViewOfFile(lpBase);
@@ -288,6 +484,28 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
             CloseHandle(hMapFile);
             hMapFile = NULL;
         }
+        if (g_shmV2) {
+            UnmapViewOfFile(g_shmV2);
+            g_shmV2 = nullptr;
+        }
+        if (hMapFileV2) {
+            CloseHandle(hMapFileV2);
+            hMapFileV2 = NULL;
+        }
+        if (g_stats) {
+            UnmapViewOfFile(g_stats);
+            g_stats = nullptr;
+        }
+        if (hMapFileStats) {
+            CloseHandle(hMapFileStats);
+            hMapFileStats = NULL;
+        }
+        for (int i = 0; i < SHM_EVENT_SLOTS; i++) {
+            if (g_frameEvents[i]) {
+                CloseHandle(g_frameEvents[i]);
+                g_frameEvents[i] = NULL;
+            }
+        }
 
         // Clean up Hook
         MH_DisableHook(MH_ALL_HOOKS);
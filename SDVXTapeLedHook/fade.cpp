@@ -0,0 +1,179 @@
+#include "fade.h"
+#include "simd_target.h"
+#include "transform_simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Ease-out: an exponential part with tau = EASE_OUT_TAU * duration plus a linear part at half
+// the linear speed lands on the target at the duration
+static constexpr float EASE_OUT_TAU = 0.797f;
+static const float LN_256 = logf(256.0f);
+
+// One direction's update for this frame: factor moves by (remaining * mul >> 16) + add,
+// never past its target
+struct FadeStep {
+    uint16_t mul;
+    uint16_t add;
+};
+
+static FadeStep MakeStep(const FadeSpeed& speed, float elapsedMs) {
+    FadeStep step = { 0, FADE_ONE };
+    if (speed.rate < 0.0f)
+        return step; // instant
+
+    float mul = speed.tau > 0.0f ? (1.0f - expf(-elapsedMs / speed.tau)) * 65536.0f : 0.0f;
+    long add = lroundf(speed.rate * elapsedMs);
+    if (elapsedMs > 0.0f && add < 1)
+        add = 1; // an exponential tail still finishes
+    step.mul = static_cast<uint16_t>(std::min(std::max(mul, 0.0f), 65535.0f));
+    step.add = static_cast<uint16_t>(std::min(add, 65535L));
+    return step;
+}
+
+static FadeSpeed MakeSpeed(float duration, FadeCurve curve) {
+    FadeSpeed speed = { 0.0f, -1.0f };
+    if (duration <= 0.0f)
+        return speed;
+
+    switch (curve) {
+        case FADE_EXPONENTIAL:
+            speed.tau = duration / LN_256;
+            speed.rate = 0.0f;
+            break;
+        case FADE_EASE_OUT:
+            speed.tau = duration * EASE_OUT_TAU;
+            speed.rate = FADE_ONE / (2.0f * duration);
+            break;
+        default:
+            speed.rate = FADE_ONE / duration;
+            break;
+    }
+    return speed;
+}
+
+void BuildFadePlan(FadePlan& plan, float fadeIn, float fadeOut, FadeCurve curve) {
+    plan.enabled = fadeIn > 0.0f || fadeOut > 0.0f;
+    plan.in = MakeSpeed(fadeIn, curve);
+    plan.out = MakeSpeed(fadeOut, curve);
+}
+
+// --- Scalar kernel ---
+
+// Output byte: src * factor, rounded (FADE_ONE gives src back)
+static inline uint8_t FadeByte(uint8_t src, uint16_t factor) {
+    return static_cast<uint8_t>(((((static_cast<uint32_t>(src) << 8) * factor) >> 16) + 128) >> 8);
+}
+
+// Bytes [begin, numBytes) of the strip
+static bool FadeScalar(StripFadeState& fs, uint8_t* data, int begin, int numBytes, FadeStep in, FadeStep out) {
+    bool settled = true;
+    for (int i = begin; i + 2 < numBytes; i += 3) {
+        bool active = (data[i] | data[i + 1] | data[i + 2]) != 0;
+        uint32_t f = fs.factor[i];
+        FadeStep s = active ? in : out;
+        uint32_t dist = active ? FADE_ONE - f : f;
+        uint32_t step = std::min(std::min(((dist * s.mul) >> 16) + s.add, 65535u), dist);
+        f = active ? f + step : f - step;
+        settled &= f == (active ? FADE_ONE : 0u);
+
+        for (int c = i; c < i + 3; c++) {
+            uint8_t src = active ? data[c] : fs.lastColor[c];
+            fs.lastColor[c] = src;
+            fs.factor[c] = static_cast<uint16_t>(f);
+            data[c] = FadeByte(src, static_cast<uint16_t>(f));
+        }
+    }
+    return settled;
+}
+
+#ifdef SDVX_X86
+
+// --- SSE4.1 kernel ---
+// 4 LEDs (12 bytes) per 16-byte block, the same block layout as the swizzle kernels: only
+// the whole LEDs are stored back. off lanes are 0xFFFF for LEDs that are black this frame.
+
+struct FadeStepsSSE41 {
+    __m128i inMul, inAdd, outMul, outAdd;
+};
+
+// Step 8 factors toward their targets and scale 8 source bytes by them. unsettled gets the
+// lanes that have not reached their target.
+SDVX_TARGET_SSE41
+static inline __m128i FadeLanesSSE41(__m128i src16, __m128i& f, __m128i off, const FadeStepsSSE41& steps,
+                                      __m128i& unsettled) {
+    __m128i ones = _mm_set1_epi16(-1);
+    __m128i dist = _mm_blendv_epi8(_mm_xor_si128(f, ones), f, off);   // FADE_ONE - f or f
+    __m128i mul = _mm_blendv_epi8(steps.inMul, steps.outMul, off);
+    __m128i add = _mm_blendv_epi8(steps.inAdd, steps.outAdd, off);
+    __m128i step = _mm_min_epu16(_mm_adds_epu16(_mm_mulhi_epu16(dist, mul), add), dist);
+    f = _mm_blendv_epi8(_mm_add_epi16(f, step), _mm_sub_epi16(f, step), off);
+    unsettled = _mm_xor_si128(f, _mm_xor_si128(off, ones));
+
+    __m128i scaled = _mm_mulhi_epu16(_mm_slli_epi16(src16, 8), f);
+    return _mm_srli_epi16(_mm_add_epi16(scaled, _mm_set1_epi16(128)), 8);
+}
+
+SDVX_TARGET_SSE41
+static bool FadeSSE41(StripFadeState& fs, uint8_t* data, int numBytes, FadeStep in, FadeStep out) {
+    // Each LED's bytes rotated by one and two, so OR-ing them gives every byte its LED's OR
+    __m128i rot1 = _mm_setr_epi8(1, 2, 0, 4, 5, 3, 7, 8, 6, 10, 11, 9, 12, 13, 14, 15);
+    __m128i rot2 = _mm_setr_epi8(2, 0, 1, 5, 3, 4, 8, 6, 7, 11, 9, 10, 12, 13, 14, 15);
+    FadeStepsSSE41 steps = {
+        _mm_set1_epi16(static_cast<short>(in.mul)), _mm_set1_epi16(static_cast<short>(in.add)),
+        _mm_set1_epi16(static_cast<short>(out.mul)), _mm_set1_epi16(static_cast<short>(out.add))
+    };
+
+    __m128i unsettled = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= numBytes; i += 12) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fs.lastColor + i));
+        __m128i any = _mm_or_si128(v, _mm_or_si128(_mm_shuffle_epi8(v, rot1), _mm_shuffle_epi8(v, rot2)));
+        __m128i off = _mm_cmpeq_epi8(any, _mm_setzero_si128());
+        __m128i src = _mm_blendv_epi8(v, last, off);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(fs.lastColor + i), src);
+        uint32_t srcLast = static_cast<uint32_t>(_mm_extract_epi32(src, 2));
+        memcpy(fs.lastColor + i + 8, &srcLast, 4);
+
+        __m128i fLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fs.factor + i));
+        __m128i fHi = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(fs.factor + i + 8));
+        __m128i uLo, uHi;
+        __m128i lo = FadeLanesSSE41(_mm_cvtepu8_epi16(src), fLo, _mm_cvtepi8_epi16(off), steps, uLo);
+        __m128i hi = FadeLanesSSE41(_mm_cvtepu8_epi16(_mm_srli_si128(src, 8)), fHi,
+                                    _mm_cvtepi8_epi16(_mm_srli_si128(off, 8)), steps, uHi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(fs.factor + i), fLo);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(fs.factor + i + 8), fHi);
+        unsettled = _mm_or_si128(unsettled, _mm_or_si128(uLo, _mm_move_epi64(uHi))); // hi: 4 lanes
+
+        __m128i packed = _mm_packus_epi16(lo, hi);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(data + i), packed);
+        uint32_t outLast = static_cast<uint32_t>(_mm_extract_epi32(packed, 2));
+        memcpy(data + i + 8, &outLast, 4);
+    }
+    bool settled = _mm_testz_si128(unsettled, unsettled) != 0;
+    return FadeScalar(fs, data, i, numBytes, in, out) && settled;
+}
+
+#endif // SDVX_X86
+
+bool RunFade(StripFadeState& fs, const FadePlan& plan, uint8_t* data, int numBytes, float elapsedMs) {
+    if (!plan.enabled)
+        return true;
+
+    FadeStep in = MakeStep(plan.in, elapsedMs);
+    FadeStep out = MakeStep(plan.out, elapsedMs);
+    if (!fs.initialized) {
+        // First call: take the LEDs as they are
+        memset(&fs, 0, sizeof(fs));
+        fs.initialized = true;
+        FadeSpeed instant = { 0.0f, -1.0f };
+        in = out = MakeStep(instant, 0.0f);
+    }
+
+#ifdef SDVX_X86
+    if (GetSimdLevel() >= SIMD_SSE41)
+        return FadeSSE41(fs, data, numBytes, in, out);
+#endif
+    return FadeScalar(fs, data, 0, numBytes, in, out);
+}
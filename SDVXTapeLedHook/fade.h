@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+// Fade engine: each LED's brightness ramps toward on (its color is non-zero) or off (black)
+// instead of switching, fading out on the last color it had.
+//
+// Factors are 0.16 fixed point (FADE_ONE = fully on) and the state is kept as separate planes
+// in the strip's byte order: one factor and one last-color byte per channel byte. The three
+// factors of an LED always hold the same value, so a vector kernel updates 4 LEDs per 16-byte
+// block without shuffling data between the RGB layout and the state.
+//
+// Every curve moves a factor toward its target by remaining * mul + add per frame, where mul and
+// add are worked out once per strip and frame from the elapsed time. Curves differ only in those
+// two numbers, so choosing one costs nothing per LED.
+
+static constexpr uint16_t FADE_ONE = 0xFFFF;
+static constexpr int FADE_MAX_BYTES = 94 * 3;   // largest strip (MAX_STRIP_LEDS, checked in transform.h)
+
+enum FadeCurve {
+    FADE_LINEAR = 0,            // constant speed
+    FADE_EXPONENTIAL,           // speed proportional to what is left (within 1/256 at the duration)
+    FADE_EASE_OUT               // fast start, slowing down, reaching the target at the duration
+};
+
+// Speed of one direction: an exponential part (time constant) and a linear part
+struct FadeSpeed {
+    float tau;                  // ms, 0 = no exponential part
+    float rate;                 // FADE_ONE per ms, < 0 = instant
+};
+
+// A strip's fade speeds, derived once from fade_in/fade_out/fade_curve at config load
+struct FadePlan {
+    bool enabled;               // false = no fade on this strip
+    FadeSpeed in;               // toward on
+    FadeSpeed out;              // toward off
+};
+
+// Per-strip state, in the strip's byte order
+struct StripFadeState {
+    uint16_t factor[FADE_MAX_BYTES];        // 0 (off) - FADE_ONE (on), same for an LED's 3 bytes
+    uint8_t lastColor[FADE_MAX_BYTES];      // color each LED fades out on
+    bool initialized;
+};
+
+// Fill a plan from durations in ms (0 = instant)
+void BuildFadePlan(FadePlan& plan, float fadeIn, float fadeOut, FadeCurve curve);
+
+// Fade a strip's transformed data in-place, elapsedMs after the previous frame. The first call
+// takes the LEDs as they are. Returns true when no LED is mid-fade, so the same data next frame
+// would come out the same.
+bool RunFade(StripFadeState& fs, const FadePlan& plan, uint8_t* data, int numBytes, float elapsedMs);
@@ -0,0 +1,20 @@
+#include "frame.h"
+#include "config.h"
+#include "stats_protocol.h"
+
+const int StripByteOffset[10] = { 0 * 3, 74 * 3, 86 * 3, 98 * 3, 154 * 3, 210 * 3, 304 * 3, 316 * 3, 328 * 3, 342 * 3 };
+
+void TransformFrame(const StripTransform strips[10], FrameState& state, const uint8_t in[FRAME_BYTES],
+                    uint8_t out[FRAME_BYTES], const FrameClock& clock, uint16_t stripMask,
+                    StatsStrip* stats) {
+    const OnsetState& onset = DetectOnset(state.onset, strips, in, stripMask, clock);
+
+    // Strips are contiguous, so walking them in order streams through in and out once
+    for (int i = 0; i < 10; i++) {
+        if (stripMask & (1 << i)) {
+            int offset = StripByteOffset[i];
+            ProcessStrip(state.strips[i], strips[i], onset, in + offset, out + offset,
+                         StripLedCount[i] * 3, clock, stats ? stats + i : nullptr);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "strip_state.h"
+
+// The 1284-byte frame layout shared by the hook, shared memory and the tools: all 10 strips
+// back to back, RGB order, 3 bytes per LED
+static constexpr int FRAME_BYTES = 1284;
+static constexpr int FRAME_LEDS = 428;
+static constexpr uint16_t ALL_STRIPS = 0x3FF;
+
+// Byte offset of each strip in a frame, indexed 0-9
+extern const int StripByteOffset[10];
+
+// Everything the frame carries between frames
+struct FrameState {
+    OnsetDetector onset;
+    StripState strips[10];
+};
+
+// Run a whole frame through the hook's path in one pass: onset detection over the raw frame
+// (once per clock frame), then each strip's pulses, transform and fade. Only strips in
+// stripMask (bit i = strip i) are processed; the others' bytes in out are left untouched. in
+// and out must not overlap. With stats (one per strip), each strip's stages are timed into
+// its histograms.
+void TransformFrame(const StripTransform strips[10], FrameState& state, const uint8_t in[FRAME_BYTES],
+                    uint8_t out[FRAME_BYTES], const FrameClock& clock, uint16_t stripMask = ALL_STRIPS,
+                    StatsStrip* stats = nullptr);
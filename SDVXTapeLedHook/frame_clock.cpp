@@ -0,0 +1,40 @@
+#include "frame_clock.h"
+#include <algorithm>
+#include <chrono>
+
+static double SteadyNow(void*) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double VirtualNow(void* ctx) {
+    return static_cast<const VirtualClock*>(ctx)->time;
+}
+
+TimeSource SteadyTimeSource() {
+    TimeSource source = { SteadyNow, nullptr };
+    return source;
+}
+
+TimeSource VirtualTimeSource(VirtualClock& clock) {
+    TimeSource source = { VirtualNow, &clock };
+    return source;
+}
+
+FrameClock StartFrameClock(double now) {
+    FrameClock clock = { now, 0.0f, 0 };
+    return clock;
+}
+
+void TickFrameClock(FrameClock& clock, double now) {
+    clock.dt = static_cast<float>(std::max(now - clock.time, 0.0));
+    clock.time = now;
+    clock.frame++;
+}
+
+FrameClock StartFrameClock(const TimeSource& source) {
+    return StartFrameClock(ReadTime(source));
+}
+
+void TickFrameClock(FrameClock& clock, const TimeSource& source) {
+    TickFrameClock(clock, ReadTime(source));
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+// The one clock every time-based effect reads (pulse travel, fades). It is ticked once per game
+// frame from a TimeSource and hands each strip the same frame time and dt. The hook ticks it
+// from QPC; replays and the golden check tick it from a VirtualClock set to each frame's
+// recorded time, so they run as fast as the CPU allows and reproduce exactly.
+
+// Current time in seconds on a monotonic clock
+typedef double (*TimeSourceFn)(void* ctx);
+
+// Where a FrameClock reads the time from (QPC, the steady clock, a VirtualClock, ...)
+struct TimeSource {
+    TimeSourceFn now;
+    void* ctx;
+};
+
+inline double ReadTime(const TimeSource& source) {
+    return source.now(source.ctx);
+}
+
+// std::chrono::steady_clock
+TimeSource SteadyTimeSource();
+
+// Time that only moves when the owner sets it
+struct VirtualClock {
+    double time;                // seconds
+};
+
+// A source reading clock.time (clock must outlive it)
+TimeSource VirtualTimeSource(VirtualClock& clock);
+
+// Time of the frame being processed (seconds on the source's clock) and time since the last one
+struct FrameClock {
+    double time;
+    float dt;
+    uint64_t frame;             // ticks since the start, so per-frame work can tell frames apart
+};
+
+// Start a clock at now (dt = 0), then advance it once per frame
+FrameClock StartFrameClock(double now);
+void TickFrameClock(FrameClock& clock, double now);
+
+// Same, reading the time from source once
+FrameClock StartFrameClock(const TimeSource& source);
+void TickFrameClock(FrameClock& clock, const TimeSource& source);
@@ -0,0 +1,103 @@
+#if defined(_MSC_VER) && !defined(_CRT_SECURE_NO_WARNINGS)
+#define _CRT_SECURE_NO_WARNINGS     // fopen: this file is shared with the portable build
+#endif
+#include "ini_file.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+static bool EqualsIgnoreCase(const std::string& a, const char* b) {
+    size_t n = strlen(b);
+    if (a.size() != n)
+        return false;
+    for (size_t i = 0; i < n; i++) {
+        char ca = (a[i] >= 'a' && a[i] <= 'z') ? static_cast<char>(a[i] - 32) : a[i];
+        char cb = (b[i] >= 'a' && b[i] <= 'z') ? static_cast<char>(b[i] - 32) : b[i];
+        if (ca != cb)
+            return false;
+    }
+    return true;
+}
+
+static std::string Trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+        return std::string();
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+void ParseIniText(IniFile& ini, const char* text, size_t size) {
+    ini.entries.clear();
+
+    std::string section;
+    const char* end = text + size;
+    for (const char* pos = text; pos < end;) {
+        const char* eol = std::find(pos, end, '\n');
+        std::string line = Trim(std::string(pos, eol));
+        pos = eol < end ? eol + 1 : end;
+        // Skip a UTF-8 BOM on the first line
+        if (line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+            line = Trim(line.substr(3));
+        if (line.empty() || line[0] == ';')
+            continue;
+
+        if (line[0] == '[') {
+            size_t close = line.find(']');
+            section = Trim(line.substr(1, close == std::string::npos ? std::string::npos : close - 1));
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos)
+            continue;
+        IniFile::Entry entry;
+        entry.section = section;
+        entry.key = Trim(line.substr(0, eq));
+        entry.value = Trim(line.substr(eq + 1));
+        if (entry.value.size() >= 2 &&
+            (entry.value.front() == '"' || entry.value.front() == '\'') &&
+            entry.value.back() == entry.value.front())
+            entry.value = entry.value.substr(1, entry.value.size() - 2);
+        ini.entries.push_back(entry);
+    }
+}
+
+bool LoadIniFile(IniFile& ini, const char* path) {
+    ini.entries.clear();
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+
+    std::string text;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        text.append(buf, n);
+    fclose(f);
+
+    ParseIniText(ini, text.data(), text.size());
+    return true;
+}
+
+static void GetFileString(void* ctx, const char* section, const char* key, const char* def,
+                          char* out, int outSize) {
+    if (outSize <= 0)
+        return;
+    const IniFile& ini = *static_cast<const IniFile*>(ctx);
+    const char* value = def ? def : "";
+    for (const IniFile::Entry& entry : ini.entries) {
+        if (EqualsIgnoreCase(entry.section, section) && EqualsIgnoreCase(entry.key, key)) {
+            value = entry.value.c_str();
+            break;
+        }
+    }
+    size_t len = std::min(strlen(value), static_cast<size_t>(outSize - 1));
+    memcpy(out, value, len);
+    out[len] = '\0';
+}
+
+IniSource MakeIniSource(const IniFile& ini) {
+    IniSource source = { GetFileString, const_cast<IniFile*>(&ini) };
+    return source;
+}
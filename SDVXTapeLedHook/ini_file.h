@@ -0,0 +1,27 @@
+#pragma once
+#include "config.h"
+#include <string>
+#include <vector>
+
+// An INI file parsed into memory, readable through IniSource with the same lookup rules as
+// GetPrivateProfileStringA: case-insensitive section and key names, first match wins, values
+// trimmed, then stripped of one pair of surrounding quotes when the first character is ' or "
+// and the last one is the same. Only lines starting with ';' are comments; like the API, '#'
+// is an ordinary character, so "#key=value" is the key "#key".
+struct IniFile {
+    struct Entry {
+        std::string section;
+        std::string key;
+        std::string value;
+    };
+    std::vector<Entry> entries;
+};
+
+// Parse INI text already in memory (replaces any previous entries)
+void ParseIniText(IniFile& ini, const char* text, size_t size);
+
+// Parse an INI file. Returns false if it cannot be opened (the IniFile is left empty).
+bool LoadIniFile(IniFile& ini, const char* path);
+
+// IniSource reading from a parsed file; the file must outlive the source
+IniSource MakeIniSource(const IniFile& ini);
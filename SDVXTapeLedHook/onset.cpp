@@ -0,0 +1,48 @@
+#include "onset.h"
+#include "frame.h"
+#include "config.h"
+#include "transform_simd.h"
+#include <algorithm>
+#include <cmath>
+
+const OnsetState& DetectOnset(OnsetDetector& det, const StripTransform strips[10], const uint8_t* in,
+                              uint16_t stripMask, const FrameClock& clock) {
+    if (det.seeded && det.frame == clock.frame)
+        return det.onset;
+
+    // Weighted mean brightness over the strips' bytes
+    float weighted = 0.0f, weight = 0.0f;
+    for (int i = 0; i < 10; i++) {
+        if (stripMask & (1 << i))
+            det.sum[i] = SumBytes(in + StripByteOffset[i], StripLedCount[i] * 3);
+        weighted += strips[i].onset_weight * static_cast<float>(det.sum[i]);
+        weight += strips[i].onset_weight * static_cast<float>(StripLedCount[i] * 3);
+    }
+    float level = weight > 0.0f ? weighted / weight : 0.0f;
+
+    det.frame = clock.frame;
+    det.onset.time = clock.time;
+    det.onset.rise = 0.0f;
+    det.onset.strength = 0.0f;
+    if (!det.seeded) {
+        // First frame: nothing to rise from
+        det.level = level;
+        det.seeded = true;
+        return det.onset;
+    }
+
+    // Strength against the statistics of the rises before this one
+    float rise = std::max(level - det.level, 0.0f);
+    float deviation = std::max(sqrtf(det.var), ONSET_MIN_DEVIATION);
+    det.onset.rise = rise;
+    det.onset.strength = std::max((rise - det.mean) / deviation, 0.0f);
+    det.level = level;
+
+    // Exponentially weighted mean and variance over about ONSET_WINDOW, whatever the frame rate
+    float alpha = 1.0f - expf(-clock.dt / ONSET_WINDOW);
+    float diff = rise - det.mean;
+    float step = alpha * diff;
+    det.mean += step;
+    det.var = (1.0f - alpha) * (det.var + diff * step);
+    return det.onset;
+}
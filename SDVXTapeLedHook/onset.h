@@ -0,0 +1,44 @@
+#pragma once
+#include "transform.h"
+#include "frame_clock.h"
+
+// Frame-level onset (beat) detection, shared by every strip's pulse engine.
+//
+// Once per frame the raw bytes of each strip are summed (SIMD) and combined into one brightness
+// level, each strip weighted by its onset_weight (e.g. woofer over wings). The level's rise
+// since the previous frame is compared against exponentially weighted running statistics of
+// past rises (mean and variance, O(1) per frame), giving an onset strength in deviations above
+// the mean. Each strip fires a pulse when the strength reaches its onset_sensitivity.
+
+static constexpr float ONSET_WINDOW = 2.0f;             // seconds the running statistics span
+static constexpr float ONSET_MIN_RISE = 4.0f;           // smallest rise (0-255 brightness) that fires
+static constexpr float ONSET_MIN_DEVIATION = 1.0f;      // floor of the deviation, so a still
+                                                        // picture does not make a flicker a beat
+
+// This frame's measurement, as the pulse engines see it
+struct OnsetState {
+    double time;                // frame clock time the frame was measured at
+    float rise;                 // weighted brightness rise since the previous frame (0 = none)
+    float strength;             // rise above the running mean in deviations (0 = at or below it)
+};
+
+struct OnsetDetector {
+    bool seeded;                // has a previous level to rise from
+    uint64_t frame;             // clock frame onset was measured for
+    uint32_t sum[10];           // last byte sum of each strip
+    float level;                // weighted brightness of the previous frame (0-255)
+    float mean;                 // running mean of the rise
+    float var;                  // running variance of the rise
+    OnsetState onset;
+};
+
+// Measure the onset of a frame (FRAME_BYTES of raw strips in). Strips outside stripMask keep
+// the sums of their last data. Runs once per clock frame: later calls for the same frame
+// return the same state, so a frame transformed strip by strip is measured as a whole.
+const OnsetState& DetectOnset(OnsetDetector& det, const StripTransform strips[10], const uint8_t* in,
+                              uint16_t stripMask, const FrameClock& clock);
+
+// Whether a strip's pulse engine fires on this frame's onset
+inline bool OnsetFires(const StripTransform& strip, const OnsetState& onset) {
+    return onset.rise >= ONSET_MIN_RISE && onset.strength >= strip.onset_sensitivity;
+}
@@ -0,0 +1,79 @@
+#include "pulse.h"
+#include <cmath>
+#include <algorithm>
+
+void BuildPulseTable(PulseTable& table, float width, float fade, uint8_t r, uint8_t g, uint8_t b) {
+    float totalHalf = std::min(width + fade, static_cast<float>(PULSE_MAX_HALF_SPAN));
+    table.entries = static_cast<int>(ceilf(totalHalf * PULSE_TABLE_STEPS)) + 1;
+    table.entries = std::min(table.entries, PULSE_TABLE_SIZE);
+    table.halfSpan = static_cast<int>(totalHalf * PULSE_POS_ONE);
+
+    // Same shape as the float renderer: solid center, cosine fade edges, nothing beyond
+    for (int i = 0; i < table.entries; i++) {
+        float dist = static_cast<float>(i) / PULSE_TABLE_STEPS;
+        float blend;
+        if (dist <= width) {
+            blend = 1.0f;
+        } else if (dist < width + fade) {
+            float t = (dist - width) / fade;
+            blend = 0.5f * (1.0f + cosf(t * 3.14159265f));
+        } else {
+            blend = 0.0f;
+        }
+        table.rgb[i][0] = static_cast<uint8_t>(r * blend);
+        table.rgb[i][1] = static_cast<uint8_t>(g * blend);
+        table.rgb[i][2] = static_cast<uint8_t>(b * blend);
+    }
+}
+
+void AdvancePulses(PulseRing& ring, float distance, int numLEDs) {
+    ring.travel += static_cast<uint32_t>(lroundf(distance * PULSE_POS_ONE));
+
+    // The oldest pulse is always the furthest along
+    int limit = numLEDs << PULSE_POS_SHIFT;
+    while (ring.count > 0 && PulsePosition(ring, 0) >= limit) {
+        ring.head = (ring.head + 1) & (MAX_PULSE_CAPACITY - 1);
+        ring.count--;
+    }
+}
+
+void SpawnPulse(PulseRing& ring, int capacity) {
+    capacity = std::min(std::max(capacity, 1), MAX_PULSE_CAPACITY);
+    while (ring.count >= capacity) {
+        ring.head = (ring.head + 1) & (MAX_PULSE_CAPACITY - 1);
+        ring.count--;
+        ring.dropped++;
+    }
+    ring.spawn[(ring.head + ring.count) & (MAX_PULSE_CAPACITY - 1)] = ring.travel;
+    ring.count++;
+}
+
+void RenderPulses(const PulseTable& table, const PulseRing& ring, uint8_t* data, int numBytes) {
+    if (table.entries == 0)
+        return;
+
+    int numLEDs = numBytes / 3;
+    for (int p = 0; p < ring.count; p++) {
+        int pos = PulsePosition(ring, p);
+        int lo = pos - table.halfSpan;
+        int minLED = lo <= 0 ? 0 : (lo + PULSE_POS_ONE - 1) >> PULSE_POS_SHIFT;
+        int maxLED = std::min(numLEDs - 1, (pos + table.halfSpan) >> PULSE_POS_SHIFT);
+
+        for (int led = minLED; led <= maxLED; led++) {
+            // Distance to the center, rounded to the nearest table entry
+            int dist = std::abs((led << PULSE_POS_SHIFT) - pos);
+            int i = (dist * PULSE_TABLE_STEPS + PULSE_POS_ONE / 2) >> PULSE_POS_SHIFT;
+            if (i >= table.entries)
+                continue;
+
+            const uint8_t* add = table.rgb[i];
+            uint8_t* px = data + led * 3;
+            int r = px[0] + add[0];
+            int g = px[1] + add[1];
+            int b = px[2] + add[2];
+            px[0] = static_cast<uint8_t>(r > 255 ? 255 : r);
+            px[1] = static_cast<uint8_t>(g > 255 ? 255 : g);
+            px[2] = static_cast<uint8_t>(b > 255 ? 255 : b);
+        }
+    }
+}
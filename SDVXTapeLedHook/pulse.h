@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+// Pulse positions are fixed-point LED indices with 8 fractional bits
+static constexpr int PULSE_POS_SHIFT = 8;
+static constexpr int PULSE_POS_ONE = 1 << PULSE_POS_SHIFT;
+
+// Falloff table resolution: entries per LED of distance from the pulse center
+static constexpr int PULSE_TABLE_STEPS = 16;
+
+// Widest pulse the table covers (half-span in LEDs); a wider pulse covers the largest strip anyway
+static constexpr int PULSE_MAX_HALF_SPAN = 94;
+static constexpr int PULSE_TABLE_SIZE = PULSE_MAX_HALF_SPAN * PULSE_TABLE_STEPS + 1;
+
+// Ring buffer storage per strip; pulse_capacity limits how much of it a strip uses
+static constexpr int MAX_PULSE_CAPACITY = 256;
+static constexpr int DEFAULT_PULSE_CAPACITY = 64;
+
+// Pulse color premultiplied by the solid center + cosine falloff, built at config load
+struct PulseTable {
+    int entries;                            // used entries (0 = pulses disabled)
+    int halfSpan;                           // width + fade in fixed-point LEDs
+    uint8_t rgb[PULSE_TABLE_SIZE][3];       // [distance * PULSE_TABLE_STEPS] -> color to add
+};
+
+// Active pulses of one strip, oldest first. All pulses of a strip move at the same speed, so
+// each one stores the strip's travel counter at spawn time and its position is the difference:
+// advancing is O(1) however many pulses are alive, and they always retire from the head.
+struct PulseRing {
+    uint32_t travel;                        // distance moved since start (fixed-point, wraps)
+    uint32_t spawn[MAX_PULSE_CAPACITY];     // travel at each pulse's spawn
+    int head;                               // index of the oldest pulse
+    int count;                              // number of active pulses
+    uint32_t dropped;                       // pulses evicted early because the ring was full
+};
+
+// Build the falloff table for a pulse shape (width/fade in LEDs, as in the INI)
+void BuildPulseTable(PulseTable& table, float width, float fade, uint8_t r, uint8_t g, uint8_t b);
+
+// Move all pulses by distance LEDs and retire those past the end of the strip
+void AdvancePulses(PulseRing& ring, float distance, int numLEDs);
+
+// Start a pulse at LED 0; evicts the oldest one when capacity pulses are already active
+void SpawnPulse(PulseRing& ring, int capacity);
+
+// Position of the i-th active pulse (0 = oldest) in fixed-point LEDs
+inline int PulsePosition(const PulseRing& ring, int i) {
+    return static_cast<int>(ring.travel - ring.spawn[(ring.head + i) & (MAX_PULSE_CAPACITY - 1)]);
+}
+
+// Add every active pulse to packed RGB data in-place, saturating at 255
+void RenderPulses(const PulseTable& table, const PulseRing& ring, uint8_t* data, int numBytes);
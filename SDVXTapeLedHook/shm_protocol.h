@@ -0,0 +1,230 @@
+#pragma once
+// Shared-memory protocol between the hook and its readers (hid_send, the Python tools).
+//
+// "sdvxrgb" is the legacy view: the bare 1284-byte RGB frame, written in place with no
+// synchronization. It stays for old readers.
+//
+// "sdvxrgb_v2" starts with a ShmHeaderV2 and carries the same frame behind a seqlock:
+// the writer makes sequence odd, writes the frame and its metadata, then makes it even again.
+// A reader copies the frame between two reads of an equal, even sequence, so it never sees a
+// torn frame and never blocks the writer. frameNumber tells a new frame from one already read;
+// dirtyMask tells which strips changed from the previous frame.
+//
+// The same frames also go into a ring of the last SHM_RING_SLOTS frames, for readers that must
+// not lose any (recorders) or that read in bursts. Each slot carries the frame number it holds,
+// cleared while the writer overwrites it, and ringHead is the newest complete frame. A reader
+// keeps its own ShmRingCursor: the writer never waits for readers, so a reader that falls more
+// than SHM_RING_SLOTS frames behind skips ahead and counts the frames it lost. The live sender
+// just takes the newest frame.
+//
+// After each v2 frame the writer signals the named auto-reset events SHM_EVENT_NAMES, one per
+// consumer slot, so a reader can block until a frame is ready instead of polling. An auto-reset
+// event wakes a single waiter, hence one event per slot: two readers sharing a slot would steal
+// each other's wakeups. Readers still check frameNumber, since a wakeup may cover several frames.
+//
+// Header only, no Windows dependencies, so external readers can include it as is.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static constexpr char SHM_LEGACY_NAME[] = "sdvxrgb";
+static constexpr char SHM_V2_NAME[] = "sdvxrgb_v2";
+
+// Frame-ready event per consumer slot
+static constexpr int SHM_EVENT_SLOTS = 4;
+static constexpr int SHM_EVENT_SLOT_SENDER = 0;     // hid_send
+static constexpr int SHM_EVENT_SLOT_CAPTURE = 1;    // Tools/sdvx_rgb_capture.py
+static constexpr const char* SHM_EVENT_NAMES[SHM_EVENT_SLOTS] = {
+    "sdvxrgb_v2_frame0", "sdvxrgb_v2_frame1", "sdvxrgb_v2_frame2", "sdvxrgb_v2_frame3"
+};
+
+static constexpr uint32_t SHM_MAGIC = 0x58564453;   // "SDVX" little-endian
+static constexpr uint16_t SHM_VERSION = 2;
+static constexpr int SHM_FRAME_BYTES = 1284;
+static constexpr int SHM_MAX_STRIPS = 10;
+static constexpr int SHM_RING_SLOTS = 128;          // power of two, about 1 s at 120 fps
+
+static_assert((SHM_RING_SLOTS & (SHM_RING_SLOTS - 1)) == 0, "ring size must be a power of two");
+
+// Where one strip lives in the frame
+struct ShmStripLayout {
+    uint16_t offset;                    // byte offset in rgb
+    uint16_t ledCount;                  // 3 bytes per LED, RGB order
+};
+
+struct ShmHeaderV2 {
+    // Static description, written once before the first frame
+    uint32_t magic;                     // SHM_MAGIC
+    uint16_t version;                   // SHM_VERSION
+    uint16_t headerSize;                // offset of rgb from the start of the mapping
+    uint32_t totalSize;                 // size of the whole mapping
+    uint16_t stripCount;
+    uint16_t frameBytes;
+    ShmStripLayout strips[SHM_MAX_STRIPS];
+    int64_t qpcFrequency;               // ticks per second of qpcTime
+    uint32_t ringOffset;                // offset of the first ring slot from the start of the mapping
+    uint32_t ringSlotSize;              // bytes from one ring slot to the next
+    uint32_t ringSlots;                 // SHM_RING_SLOTS
+
+    // Per-frame fields, protected by sequence (on their own cache line)
+    alignas(64) std::atomic<uint32_t> sequence; // odd while a frame is being written
+    uint32_t dirtyMask;                 // bit i = strip i changed from the previous frame
+    uint64_t frameNumber;               // increments with every frame, starting at 1
+    int64_t qpcTime;                    // QPC ticks when the frame was published
+    std::atomic<uint64_t> ringHead;     // newest frame complete in the ring, 0 before the first
+};
+
+// One frame of the ring
+struct ShmRingSlot {
+    std::atomic<uint64_t> frameNumber;  // frame held here, 0 while being written
+    uint32_t dirtyMask;
+    uint32_t reserved;
+    int64_t qpcTime;
+    alignas(64) uint8_t rgb[SHM_FRAME_BYTES];
+};
+
+// The whole v2 mapping: header, the newest frame, then the ring, each on its own cache line
+struct ShmFrameV2 {
+    ShmHeaderV2 header;
+    alignas(64) uint8_t rgb[SHM_FRAME_BYTES];
+    alignas(64) ShmRingSlot ring[SHM_RING_SLOTS];
+};
+
+static_assert(offsetof(ShmHeaderV2, sequence) == 128, "v2 layout changed");
+static_assert(offsetof(ShmHeaderV2, ringHead) == 152, "v2 layout changed");
+static_assert(offsetof(ShmFrameV2, rgb) == 192, "v2 layout changed");
+static_assert(offsetof(ShmFrameV2, ring) == 1536, "v2 layout changed");
+static_assert(sizeof(ShmRingSlot) == 1408 && offsetof(ShmRingSlot, rgb) == 64, "v2 layout changed");
+static_assert(sizeof(std::atomic<uint32_t>) == 4 && sizeof(std::atomic<uint64_t>) == 8,
+              "atomics must be plain words");
+
+// Fill in the static header of a freshly created mapping
+inline void InitShmV2(ShmFrameV2* shm, const int* stripOffsets, const int* stripLedCounts,
+                      int stripCount, int64_t qpcFrequency) {
+    memset(static_cast<void*>(shm), 0, sizeof(*shm));
+    shm->header.magic = SHM_MAGIC;
+    shm->header.version = SHM_VERSION;
+    shm->header.headerSize = static_cast<uint16_t>(offsetof(ShmFrameV2, rgb));
+    shm->header.totalSize = sizeof(ShmFrameV2);
+    shm->header.stripCount = static_cast<uint16_t>(stripCount);
+    shm->header.frameBytes = SHM_FRAME_BYTES;
+    for (int i = 0; i < stripCount && i < SHM_MAX_STRIPS; i++) {
+        shm->header.strips[i].offset = static_cast<uint16_t>(stripOffsets[i]);
+        shm->header.strips[i].ledCount = static_cast<uint16_t>(stripLedCounts[i]);
+    }
+    shm->header.qpcFrequency = qpcFrequency;
+    shm->header.ringOffset = static_cast<uint32_t>(offsetof(ShmFrameV2, ring));
+    shm->header.ringSlotSize = sizeof(ShmRingSlot);
+    shm->header.ringSlots = SHM_RING_SLOTS;
+}
+
+// Writer side: publish a frame (single writer only)
+inline void PublishShmV2(ShmFrameV2* shm, const uint8_t* rgb, uint32_t dirtyMask, int64_t qpcTime) {
+    ShmHeaderV2& h = shm->header;
+    uint32_t seq = h.sequence.load(std::memory_order_relaxed);
+    h.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(shm->rgb, rgb, SHM_FRAME_BYTES);
+    h.dirtyMask = dirtyMask;
+    uint64_t frameNumber = ++h.frameNumber;
+    h.qpcTime = qpcTime;
+
+    h.sequence.store(seq + 2, std::memory_order_release);
+
+    // Same frame into the ring, replacing the oldest one
+    ShmRingSlot& slot = shm->ring[frameNumber & (SHM_RING_SLOTS - 1)];
+    slot.frameNumber.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(slot.rgb, rgb, SHM_FRAME_BYTES);
+    slot.dirtyMask = dirtyMask;
+    slot.qpcTime = qpcTime;
+
+    slot.frameNumber.store(frameNumber, std::memory_order_release);
+    h.ringHead.store(frameNumber, std::memory_order_release);
+}
+
+// What a reader gets along with the frame
+struct ShmFrameInfo {
+    uint64_t frameNumber;
+    uint32_t dirtyMask;
+    int64_t qpcTime;
+};
+
+// Reader side: copy a consistent frame. Returns false if the mapping is not a v2 header or no
+// consistent copy was possible within maxAttempts (the writer kept publishing meanwhile).
+inline bool ReadShmV2(const ShmFrameV2* shm, uint8_t* rgb, ShmFrameInfo& info, int maxAttempts = 64) {
+    const ShmHeaderV2& h = shm->header;
+    if (h.magic != SHM_MAGIC || h.version != SHM_VERSION)
+        return false;
+
+    for (int attempt = 0; attempt < maxAttempts; attempt++) {
+        uint32_t before = h.sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        memcpy(rgb, shm->rgb, SHM_FRAME_BYTES);
+        info.frameNumber = h.frameNumber;
+        info.dirtyMask = h.dirtyMask;
+        info.qpcTime = h.qpcTime;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h.sequence.load(std::memory_order_relaxed) == before)
+            return true;
+    }
+    return false;
+}
+
+// A reader's position in the ring
+struct ShmRingCursor {
+    uint64_t next;                      // frame number to read next
+    uint64_t lost;                      // frames overwritten before this reader got to them
+};
+
+// Cursor that starts with the next frame published
+inline ShmRingCursor ShmRingCursorAtHead(const ShmFrameV2* shm) {
+    ShmRingCursor cursor;
+    cursor.next = shm->header.ringHead.load(std::memory_order_acquire) + 1;
+    cursor.lost = 0;
+    return cursor;
+}
+
+// Reader side: copy the frame at the cursor and advance it. Returns false when the reader has
+// caught up with the writer (or the mapping is not a v2 header). Frames the writer overwrote
+// before they were read are skipped and added to cursor.lost.
+inline bool ReadShmRing(const ShmFrameV2* shm, ShmRingCursor& cursor, uint8_t* rgb, ShmFrameInfo& info,
+                        int maxAttempts = 64) {
+    const ShmHeaderV2& h = shm->header;
+    if (h.magic != SHM_MAGIC || h.version != SHM_VERSION)
+        return false;
+
+    for (int attempt = 0; attempt < maxAttempts; attempt++) {
+        uint64_t head = h.ringHead.load(std::memory_order_acquire);
+        if (cursor.next > head)
+            return false;
+
+        uint64_t oldest = head >= SHM_RING_SLOTS ? head - SHM_RING_SLOTS + 1 : 1;
+        if (cursor.next < oldest) {
+            cursor.lost += oldest - cursor.next;
+            cursor.next = oldest;
+        }
+
+        const ShmRingSlot& slot = shm->ring[cursor.next & (SHM_RING_SLOTS - 1)];
+        if (slot.frameNumber.load(std::memory_order_acquire) != cursor.next)
+            continue;   // being overwritten: the head has moved past it
+
+        memcpy(rgb, slot.rgb, SHM_FRAME_BYTES);
+        info.frameNumber = cursor.next;
+        info.dirtyMask = slot.dirtyMask;
+        info.qpcTime = slot.qpcTime;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.frameNumber.load(std::memory_order_relaxed) == cursor.next) {
+            cursor.next++;
+            return true;
+        }
+    }
+    return false;
+}
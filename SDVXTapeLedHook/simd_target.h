@@ -0,0 +1,17 @@
+#pragma once
+// x86 SIMD plumbing shared by the vectorized kernels (transform_simd.cpp, fade.cpp)
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SDVX_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC/Clang only emit SSE4.1/AVX2 instructions in functions that ask for them;
+// MSVC always allows the intrinsics, so the attribute is empty there.
+#if defined(SDVX_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SDVX_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SDVX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SDVX_TARGET_SSE41
+#define SDVX_TARGET_AVX2
+#endif
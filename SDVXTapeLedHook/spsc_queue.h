@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Bounded single-producer single-consumer queue of fixed slots. The producer fills the next slot
+// in place and commits it; the consumer works on the oldest slot in place and then releases it.
+// No locks, no allocation, and a full queue is reported to the producer instead of waiting.
+// A zero-initialized queue is empty.
+template <typename T, uint32_t Depth>
+struct SpscQueue {
+    static_assert((Depth & (Depth - 1)) == 0, "queue depth must be a power of two");
+
+    alignas(64) std::atomic<uint32_t> head;     // slots committed (producer)
+    alignas(64) std::atomic<uint32_t> tail;     // slots released (consumer)
+    alignas(64) T slots[Depth];
+
+    // Producer: the slot to fill next, nullptr if the queue is full
+    T* BeginPush() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Depth)
+            return nullptr;
+        return &slots[h & (Depth - 1)];
+    }
+
+    // Producer: hand the slot from BeginPush to the consumer
+    void CommitPush() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: the oldest committed slot, nullptr if the queue is empty
+    T* Front() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots[t & (Depth - 1)];
+    }
+
+    // Consumer: give the slot from Front back to the producer
+    void Pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Committed slots not yet released (exact from either side's own thread)
+    uint32_t Size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,191 @@
+#pragma once
+// Hook latency statistics, published in the "sdvxrgb_stats" mapping (Tools/sdvx_stats.py).
+//
+// The hook times its stages with StatsTimestamp (the TSC on x86) and counts each sample into
+// a log-bucketed histogram: four buckets per power of two, so a bucket's bounds are within 25%
+// of any sample in it. Per strip: the whole hook call, pulse update, transform, fade and
+// the original SetTapeLedData call, plus call and cache-hit counters. Per frame: the config
+// check, the shared-memory publish and the whole transform pass.
+//
+// Counters only ever grow. Each histogram has a single writer and is read without
+// synchronization, so a reader may see a sample in count but not yet in its bucket; readers
+// take two snapshots and report the difference, which makes percentiles live.
+//
+// Instrumentation runs only while enabled is non-zero. Any reader may set it (the hook starts
+// with [hook] stats); while it is zero the hook pays a flag check per call and a branch per stage.
+//
+// Header only, no Windows dependencies, so external readers can include it as is.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define STATS_HAVE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STATS_HAVE_TSC 1
+#else
+#include <chrono>
+#endif
+
+static constexpr char STATS_SHM_NAME[] = "sdvxrgb_stats";
+static constexpr uint32_t STATS_MAGIC = 0x54534453;     // "SDST" little-endian
+static constexpr uint16_t STATS_VERSION = 1;
+static constexpr int STATS_BUCKETS = 128;               // up to 2^32 ticks, about a second
+static constexpr int STATS_MAX_STRIPS = 10;
+
+// Timed per strip
+enum StatsStripStage {
+    STATS_STAGE_HOOK,           // SetTapeLedDataHook, original function excluded
+    STATS_STAGE_BEAT,           // pulse update on the frame's onset (detection is in the pass)
+    STATS_STAGE_TRANSFORM,      // transform kernel and pulse rendering
+    STATS_STAGE_FADE,
+    STATS_STAGE_ORIGINAL,       // the game's SetTapeLedData
+    STATS_STRIP_STAGES
+};
+
+// Timed per frame
+enum StatsFrameStage {
+    STATS_FRAME_CONFIG,         // picking up the newest config
+    STATS_FRAME_PUBLISH,        // shared memory and frame-ready events
+    STATS_FRAME_PASS,           // config check to publish, the whole frame
+    STATS_FRAME_STAGES
+};
+
+struct alignas(64) StatsHistogram {
+    uint64_t count;
+    uint64_t sumTicks;
+    uint64_t maxTicks;
+    uint64_t reserved;
+    uint32_t buckets[STATS_BUCKETS];
+};
+
+struct StatsStrip {
+    uint64_t calls;                     // hook calls for this strip
+    uint64_t cacheHits;                 // strips served from the unchanged-input cache; the
+                                        // others are counted by stages[STATS_STAGE_BEAT]
+    StatsHistogram stages[STATS_STRIP_STAGES];
+};
+
+struct StatsBlock {
+    // Static description, written once before the first sample
+    uint32_t magic;                     // STATS_MAGIC
+    uint16_t version;                   // STATS_VERSION
+    uint16_t buckets;                   // STATS_BUCKETS
+    uint32_t totalSize;                 // size of the whole mapping
+    uint16_t stripCount;
+    uint16_t stripStages;               // STATS_STRIP_STAGES
+    uint16_t frameStages;               // STATS_FRAME_STAGES
+    uint16_t reserved;
+    uint32_t histogramSize;             // bytes from one histogram to the next
+    uint32_t frameOffset;               // offset of frame[0] from the start of the mapping
+    uint32_t stripOffset;               // offset of strips[0]
+    uint32_t stripSize;                 // bytes from one strip to the next
+    int64_t ticksPerSecond;             // of the histograms' ticks, refined while the hook runs
+
+    // Control and frame counter (on their own cache line)
+    alignas(64) std::atomic<uint32_t> enabled;
+    uint32_t reserved2;
+    uint64_t frames;                    // frames published while enabled
+
+    StatsHistogram frame[STATS_FRAME_STAGES];
+    StatsStrip strips[STATS_MAX_STRIPS];
+};
+
+static_assert(sizeof(StatsHistogram) == 576 && offsetof(StatsHistogram, buckets) == 32, "stats layout changed");
+static_assert(offsetof(StatsStrip, stages) == 64 && sizeof(StatsStrip) == 2944, "stats layout changed");
+static_assert(offsetof(StatsBlock, ticksPerSecond) == 40, "stats layout changed");
+static_assert(offsetof(StatsBlock, enabled) == 64 && offsetof(StatsBlock, frames) == 72, "stats layout changed");
+static_assert(offsetof(StatsBlock, frame) == 128 && offsetof(StatsBlock, strips) == 1856, "stats layout changed");
+
+// Fill in the static header of a freshly created block
+inline void InitStatsBlock(StatsBlock* stats, int stripCount, int64_t ticksPerSecond, bool enabled) {
+    memset(static_cast<void*>(stats), 0, sizeof(*stats));
+    stats->magic = STATS_MAGIC;
+    stats->version = STATS_VERSION;
+    stats->buckets = STATS_BUCKETS;
+    stats->totalSize = sizeof(StatsBlock);
+    stats->stripCount = static_cast<uint16_t>(stripCount);
+    stats->stripStages = STATS_STRIP_STAGES;
+    stats->frameStages = STATS_FRAME_STAGES;
+    stats->histogramSize = sizeof(StatsHistogram);
+    stats->frameOffset = static_cast<uint32_t>(offsetof(StatsBlock, frame));
+    stats->stripOffset = static_cast<uint32_t>(offsetof(StatsBlock, strips));
+    stats->stripSize = sizeof(StatsStrip);
+    stats->ticksPerSecond = ticksPerSecond;
+    stats->enabled.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
+
+// Writer side: the timestamp samples are taken with. The TSC where there is one (its rate is
+// unknown here, so the writer calibrates ticksPerSecond against another clock), else ns.
+inline uint64_t StatsTimestamp() {
+#ifdef STATS_HAVE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Bucket of a sample: exact below 4 ticks, then 4 buckets per power of two
+inline int StatsBucket(uint64_t ticks) {
+    if (ticks < 4)
+        return static_cast<int>(ticks);
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long msb;
+    _BitScanReverse64(&msb, ticks);
+#elif defined(_MSC_VER)
+    int msb = 63;
+    while (!(ticks >> msb))
+        msb--;
+#else
+    int msb = 63 - __builtin_clzll(ticks);
+#endif
+    int bucket = (msb - 1) * 4 + static_cast<int>((ticks >> (msb - 2)) & 3);
+    return bucket < STATS_BUCKETS ? bucket : STATS_BUCKETS - 1;
+}
+
+// Smallest sample that lands in a bucket; bucket + 1 gives the exclusive upper bound
+inline uint64_t StatsBucketLow(int bucket) {
+    if (bucket < 4)
+        return static_cast<uint64_t>(bucket);
+    return static_cast<uint64_t>(4 + (bucket & 3)) << (bucket / 4 - 1);
+}
+
+// Writer side: count one sample (single writer per histogram)
+inline void RecordStats(StatsHistogram& h, uint64_t ticks) {
+    h.buckets[StatsBucket(ticks)]++;
+    h.count++;
+    h.sumTicks += ticks;
+    if (ticks > h.maxTicks)
+        h.maxTicks = ticks;
+}
+
+// Writer side: close a stage that started at last, and start the next one now
+inline void StatsLap(StatsHistogram& h, uint64_t& last) {
+    uint64_t now = StatsTimestamp();
+    RecordStats(h, now - last);
+    last = now;
+}
+
+// Reader side: upper bound, in ticks, of the p-quantile (0-1) of a histogram's buckets.
+// Returns 0 when the histogram is empty.
+inline uint64_t StatsPercentile(const uint32_t buckets[STATS_BUCKETS], double p) {
+    uint64_t total = 0;
+    for (int i = 0; i < STATS_BUCKETS; i++)
+        total += buckets[i];
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(p * total + 0.5);
+    if (rank < 1)
+        rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < STATS_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return i + 1 < STATS_BUCKETS ? StatsBucketLow(i + 1) - 1 : ~0ull;
+    }
+    return ~0ull;
+}
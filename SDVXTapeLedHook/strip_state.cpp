@@ -0,0 +1,69 @@
+#include "strip_state.h"
+#include "stats_protocol.h"
+#include <cstring>
+#include <algorithm>
+
+// Longest step a state machine takes in one update, so a stall does not skip a whole fade
+static constexpr float MAX_ELAPSED = 0.1f;
+
+static float Elapsed(const FrameClock& clock) {
+    return clock.dt > MAX_ELAPSED ? MAX_ELAPSED : clock.dt; // clamp to 100ms
+}
+
+const PulseRing* UpdatePulses(StripPulseState& ps, const StripTransform& strip, const OnsetState& onset,
+                              int numLEDs, const FrameClock& clock) {
+    if (!strip.pulse_color_enabled)
+        return nullptr;
+
+    // Advance all active pulses and remove finished ones
+    AdvancePulses(ps.ring, strip.pulse_speed * Elapsed(clock), numLEDs);
+
+    if (OnsetFires(strip, onset))
+        SpawnPulse(ps.ring, strip.pulse_capacity);
+    return &ps.ring;
+}
+
+bool ApplyFade(StripFadeState& fs, const StripTransform& strip, uint8_t* data, int numBytes,
+               const FrameClock& clock) {
+    return RunFade(fs, strip.plan.fade, data, numBytes, Elapsed(clock) * 1000.0f);
+}
+
+void ProcessStrip(StripState& state, const StripTransform& strip, const OnsetState& onset,
+                  const uint8_t* in, uint8_t* out, int numBytes, const FrameClock& clock,
+                  StatsStrip* stats) {
+    // Same input under the same plan as a frame that left nothing animating: same output,
+    // unless the frame's onset spawns a pulse here
+    StripCache& cache = state.cache;
+    if (cache.valid && cache.generation == strip.plan.generation && cache.numBytes == numBytes &&
+        !(strip.pulse_color_enabled && OnsetFires(strip, onset)) && memcmp(cache.in, in, numBytes) == 0) {
+        memcpy(out, cache.out, numBytes);
+        cache.hits++;
+        if (stats)
+            stats->cacheHits++;
+        return;
+    }
+    cache.misses++;
+
+    uint64_t lap = stats ? StatsTimestamp() : 0;
+    const PulseRing* pulses = UpdatePulses(state.pulse, strip, onset, numBytes / 3, clock);
+    if (stats)
+        StatsLap(stats->stages[STATS_STAGE_BEAT], lap);
+
+    memcpy(out, in, numBytes);
+    TransformStrip(strip, out, numBytes, pulses);
+    if (stats)
+        StatsLap(stats->stages[STATS_STAGE_TRANSFORM], lap);
+
+    bool settled = ApplyFade(state.fade, strip, out, numBytes, clock);
+    if (stats)
+        StatsLap(stats->stages[STATS_STAGE_FADE], lap);
+
+    // Pulses move and fades ramp with time, so only a strip with neither can be cached
+    cache.valid = settled && (!pulses || pulses->count == 0);
+    if (cache.valid) {
+        cache.numBytes = numBytes;
+        cache.generation = strip.plan.generation;
+        memcpy(cache.in, in, numBytes);
+        memcpy(cache.out, out, numBytes);
+    }
+}
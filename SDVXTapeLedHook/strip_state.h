@@ -0,0 +1,53 @@
+#pragma once
+#include "transform.h"
+#include "fade.h"
+#include "frame_clock.h"
+#include "onset.h"
+
+struct StatsStrip;   // stats_protocol.h
+
+// Per-strip state that evolves across frames. Time is passed in by the caller as a FrameClock
+// (frame_clock.h), so the state machines run the same under the hook, a replay or a test.
+
+// Pulse state for beat-triggered traveling pulses (multiple per strip)
+struct StripPulseState {
+    PulseRing ring;                     // active pulses, oldest first
+};
+
+// Advance the pulses and spawn one if the frame's onset fires for this strip. Returns the
+// pulses to render, or nullptr when the strip has no pulse color.
+const PulseRing* UpdatePulses(StripPulseState& ps, const StripTransform& strip, const OnsetState& onset,
+                              int numLEDs, const FrameClock& clock);
+
+// Apply the strip's fade plan to transformed data in-place (no-op when the strip has no fade).
+// Returns true when no LED is mid-fade, so the same data next frame would come out the same.
+bool ApplyFade(StripFadeState& fs, const StripTransform& strip, uint8_t* data, int numBytes,
+               const FrameClock& clock);
+
+// Last input and output of a strip whose output did not depend on time: no pulse on the strip
+// and no LED mid-fade. Until that changes, the same input under the same plan gives the same
+// output, so the strip's stages can be skipped.
+struct StripCache {
+    bool valid;
+    int numBytes;
+    uint32_t generation;                // plan.generation the output was made with
+    uint8_t in[MAX_STRIP_LEDS * 3];
+    uint8_t out[MAX_STRIP_LEDS * 3];
+    uint64_t hits;                      // strips served from the cache
+    uint64_t misses;                    // strips run through the stages
+};
+
+// Everything one strip carries between frames
+struct StripState {
+    StripFadeState fade;
+    StripPulseState pulse;
+    StripCache cache;
+};
+
+// The hook's per-strip path: pulse update on the frame's onset, transform with pulses, then
+// fade. Reads in, writes out (numBytes each; they must not overlap). Unchanged input is
+// answered from state.cache while nothing on the strip is animating and no pulse is due.
+// With stats, each stage's time is counted into its histogram.
+void ProcessStrip(StripState& state, const StripTransform& strip, const OnsetState& onset,
+                  const uint8_t* in, uint8_t* out, int numBytes, const FrameClock& clock,
+                  StatsStrip* stats = nullptr);
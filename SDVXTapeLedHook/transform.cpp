@@ -1,23 +1,24 @@
 #include "transform.h"
+#include "transform_simd.h"
+#include <atomic>
+#include <mutex>
 #include <cmath>
+#include <cstdio>
 #include <cstring>
 #include <algorithm>
 
-// How many hook calls between reload checks (~300 calls ≈ 3 seconds at 10 calls/frame * 60fps)
-static constexpr int RELOAD_INTERVAL = 300;
-
-const char* StripSectionNames[10] = {
-    "title",
-    "upper_left_speaker",
-    "upper_right_speaker",
-    "left_wing",
-    "right_wing",
-    "ctrl_panel",
-    "lower_left_speaker",
-    "lower_right_speaker",
-    "woofer",
-    "v_unit"
-};
+static void LogToStderr(const char* message) {
+    fputs(message, stderr);
+}
+
+static TransformLogFn g_log = LogToStderr;
+
+void SetTransformLog(TransformLogFn fn) {
+    g_log = fn ? fn : LogToStderr;
+}
+
+// Last plan generation handed out (plans are built on the hook's and the watcher's threads)
+static std::atomic<uint32_t> g_planGeneration(0);
 
 // Build a gamma lookup table for a given gamma value
 static void BuildGammaLUT(uint8_t lut[256], float gamma) {
@@ -35,310 +36,6 @@ static void BuildGammaLUT(uint8_t lut[256], float gamma) {
     }
 }
 
-// Parse a ChannelOrder from a string like "RGB", "GBR", etc.
-static ChannelOrder ParseChannelOrder(const char* str) {
-    if (_stricmp(str, "RBG") == 0) return CH_RBG;
-    if (_stricmp(str, "GRB") == 0) return CH_GRB;
-    if (_stricmp(str, "GBR") == 0) return CH_GBR;
-    if (_stricmp(str, "BRG") == 0) return CH_BRG;
-    if (_stricmp(str, "BGR") == 0) return CH_BGR;
-    return CH_RGB;
-}
-
-// Parse a hex color string like "8000FF" or "#8000FF" into r, g, b. Returns true on success.
-static bool ParseHexColor(const char* str, uint8_t& r, uint8_t& g, uint8_t& b) {
-    if (!str || str[0] == '\0')
-        return false;
-    const char* hex = str;
-    if (hex[0] == '#') hex++;
-    if (strlen(hex) != 6)
-        return false;
-    unsigned int val;
-    if (sscanf_s(hex, "%06x", &val) != 1)
-        return false;
-    r = static_cast<uint8_t>((val >> 16) & 0xFF);
-    g = static_cast<uint8_t>((val >> 8) & 0xFF);
-    b = static_cast<uint8_t>(val & 0xFF);
-    return true;
-}
-
-// Read a float value from INI (GetPrivateProfileString then atof)
-static float GetProfileFloat(const char* section, const char* key, float defaultVal, const char* path) {
-    char buf[64];
-    char defBuf[64];
-    sprintf_s(defBuf, "%.4f", defaultVal);
-    GetPrivateProfileStringA(section, key, defBuf, buf, sizeof(buf), path);
-    return static_cast<float>(atof(buf));
-}
-
-// Load settings for one strip from a given INI section, with fallback defaults
-static void LoadStripFromSection(StripTransform& strip, const char* section,
-                                  const StripTransform& defaults, const char* path) {
-    char orderStr[16];
-    // Determine the default channel order string for GetPrivateProfileString fallback
-    const char* defOrder = "RGB";
-    switch (defaults.channelOrder) {
-        case CH_RBG: defOrder = "RBG"; break;
-        case CH_GRB: defOrder = "GRB"; break;
-        case CH_GBR: defOrder = "GBR"; break;
-        case CH_BRG: defOrder = "BRG"; break;
-        case CH_BGR: defOrder = "BGR"; break;
-        default: defOrder = "RGB"; break;
-    }
-
-    GetPrivateProfileStringA(section, "channel_order", defOrder, orderStr, sizeof(orderStr), path);
-    strip.channelOrder = ParseChannelOrder(orderStr);
-
-    strip.gamma_r = GetProfileFloat(section, "gamma_r", defaults.gamma_r, path);
-    strip.gamma_g = GetProfileFloat(section, "gamma_g", defaults.gamma_g, path);
-    strip.gamma_b = GetProfileFloat(section, "gamma_b", defaults.gamma_b, path);
-
-    strip.hue_shift = GetPrivateProfileIntA(section, "hue_shift", defaults.hue_shift, path);
-    strip.saturation = GetPrivateProfileIntA(section, "saturation", defaults.saturation, path);
-    strip.brightness = GetPrivateProfileIntA(section, "brightness", defaults.brightness, path);
-    strip.contrast = GetPrivateProfileIntA(section, "contrast", defaults.contrast, path);
-
-    // Clamp values
-    strip.hue_shift = ((strip.hue_shift % 360) + 360) % 360;
-    strip.saturation = std::min(std::max(strip.saturation, 0), 200);
-    strip.brightness = std::min(std::max(strip.brightness, 0), 200);
-    strip.contrast = std::min(std::max(strip.contrast, 0), 200);
-
-    // Parse static_color (hex RGB like "8000FF" or "#8000FF")
-    char colorStr[16];
-    GetPrivateProfileStringA(section, "static_color", "", colorStr, sizeof(colorStr), path);
-    if (ParseHexColor(colorStr, strip.static_r, strip.static_g, strip.static_b)) {
-        strip.static_color_enabled = true;
-    } else {
-        strip.static_color_enabled = defaults.static_color_enabled;
-        strip.static_r = defaults.static_r;
-        strip.static_g = defaults.static_g;
-        strip.static_b = defaults.static_b;
-    }
-
-    // Parse gradient_color (second color for gradient; requires static_color to be set)
-    char gradStr[16];
-    GetPrivateProfileStringA(section, "gradient_color", "", gradStr, sizeof(gradStr), path);
-    if (strip.static_color_enabled && ParseHexColor(gradStr, strip.gradient_r2, strip.gradient_g2, strip.gradient_b2)) {
-        strip.gradient_enabled = true;
-    } else {
-        strip.gradient_enabled = defaults.gradient_enabled;
-        strip.gradient_r2 = defaults.gradient_r2;
-        strip.gradient_g2 = defaults.gradient_g2;
-        strip.gradient_b2 = defaults.gradient_b2;
-    }
-
-    // Parse pulse_color
-    char pulseStr[16];
-    GetPrivateProfileStringA(section, "pulse_color", "", pulseStr, sizeof(pulseStr), path);
-    if (ParseHexColor(pulseStr, strip.pulse_r, strip.pulse_g, strip.pulse_b)) {
-        strip.pulse_color_enabled = true;
-    } else {
-        strip.pulse_color_enabled = defaults.pulse_color_enabled;
-        strip.pulse_r = defaults.pulse_r;
-        strip.pulse_g = defaults.pulse_g;
-        strip.pulse_b = defaults.pulse_b;
-    }
-
-    strip.pulse_speed = GetProfileFloat(section, "pulse_speed", defaults.pulse_speed, path);
-    strip.pulse_width = GetProfileFloat(section, "pulse_width", defaults.pulse_width, path);
-    strip.pulse_fade = GetProfileFloat(section, "pulse_fade", defaults.pulse_fade, path);
-    strip.pulse_speed = std::max(strip.pulse_speed, 10.0f);
-    strip.pulse_width = std::max(strip.pulse_width, 0.0f);
-    strip.pulse_fade = std::max(strip.pulse_fade, 0.5f);
-
-    strip.fade_in = GetProfileFloat(section, "fade_in", defaults.fade_in, path);
-    strip.fade_out = GetProfileFloat(section, "fade_out", defaults.fade_out, path);
-    strip.fade_in = std::max(strip.fade_in, 0.0f);
-    strip.fade_out = std::max(strip.fade_out, 0.0f);
-
-    // Build gamma LUTs
-    BuildGammaLUT(strip.lut_r, strip.gamma_r);
-    BuildGammaLUT(strip.lut_g, strip.gamma_g);
-    BuildGammaLUT(strip.lut_b, strip.gamma_b);
-
-    // Determine if any transform is actually active
-    strip.enabled = (strip.channelOrder != CH_RGB ||
-                     strip.gamma_r != 1.0f ||
-                     strip.gamma_g != 1.0f ||
-                     strip.gamma_b != 1.0f ||
-                     strip.hue_shift != 0 ||
-                     strip.saturation != 100 ||
-                     strip.brightness != 100 ||
-                     strip.contrast != 100 ||
-                     strip.static_color_enabled ||
-                     strip.gradient_enabled ||
-                     strip.pulse_color_enabled ||
-                     strip.fade_in > 0.0f ||
-                     strip.fade_out > 0.0f);
-}
-
-void InitConfig(TransformConfig& config, HMODULE hModule) {
-    memset(&config, 0, sizeof(config));
-
-    // Resolve INI path: same directory as the DLL
-    wchar_t dllPath[MAX_PATH];
-    GetModuleFileNameW(hModule, dllPath, MAX_PATH);
-    // Find last backslash and replace filename
-    wchar_t* lastSlash = wcsrchr(dllPath, L'\\');
-    if (lastSlash) {
-        *(lastSlash + 1) = L'\0';
-    }
-    wcscpy_s(config.iniPath, dllPath);
-    wcscat_s(config.iniPath, L"sdvxrgb.ini");
-
-    config.callCounter = 0;
-    config.lastWriteTime = {};
-
-    // Set identity defaults for all strips
-    for (int i = 0; i < 10; i++) {
-        config.strips[i].enabled = false;
-        config.strips[i].channelOrder = CH_RGB;
-        config.strips[i].gamma_r = 1.0f;
-        config.strips[i].gamma_g = 1.0f;
-        config.strips[i].gamma_b = 1.0f;
-        config.strips[i].hue_shift = 0;
-        config.strips[i].saturation = 100;
-        config.strips[i].brightness = 100;
-        config.strips[i].contrast = 100;
-        config.strips[i].static_color_enabled = false;
-        config.strips[i].static_r = 0;
-        config.strips[i].static_g = 0;
-        config.strips[i].static_b = 0;
-        config.strips[i].gradient_enabled = false;
-        config.strips[i].gradient_r2 = 0;
-        config.strips[i].gradient_g2 = 0;
-        config.strips[i].gradient_b2 = 0;
-        config.strips[i].pulse_color_enabled = false;
-        config.strips[i].pulse_r = 0;
-        config.strips[i].pulse_g = 0;
-        config.strips[i].pulse_b = 0;
-        config.strips[i].pulse_speed = 150.0f;
-        config.strips[i].pulse_width = 2.0f;
-        config.strips[i].pulse_fade = 4.0f;
-        config.strips[i].fade_in = 0.0f;
-        config.strips[i].fade_out = 0.0f;
-        BuildGammaLUT(config.strips[i].lut_r, 1.0f);
-        BuildGammaLUT(config.strips[i].lut_g, 1.0f);
-        BuildGammaLUT(config.strips[i].lut_b, 1.0f);
-    }
-}
-
-void LoadConfig(TransformConfig& config) {
-    // Convert wide path to ANSI for GetPrivateProfileIntA/StringA
-    char iniPathA[MAX_PATH];
-    WideCharToMultiByte(CP_ACP, 0, config.iniPath, -1, iniPathA, MAX_PATH, nullptr, nullptr);
-
-    // Check if file exists
-    DWORD attr = GetFileAttributesW(config.iniPath);
-    if (attr == INVALID_FILE_ATTRIBUTES) {
-        // No config file — all strips stay at identity defaults
-        for (int i = 0; i < 10; i++) {
-            config.strips[i].enabled = false;
-        }
-        return;
-    }
-
-    // Update last write time
-    HANDLE hFile = CreateFileW(config.iniPath, GENERIC_READ, FILE_SHARE_READ,
-                               nullptr, OPEN_EXISTING, 0, nullptr);
-    if (hFile != INVALID_HANDLE_VALUE) {
-        GetFileTime(hFile, nullptr, nullptr, &config.lastWriteTime);
-        CloseHandle(hFile);
-    }
-
-    // Load [global] defaults first
-    StripTransform globalDefaults;
-    globalDefaults.channelOrder = CH_RGB;
-    globalDefaults.gamma_r = 1.0f;
-    globalDefaults.gamma_g = 1.0f;
-    globalDefaults.gamma_b = 1.0f;
-    globalDefaults.hue_shift = 0;
-    globalDefaults.saturation = 100;
-    globalDefaults.brightness = 100;
-    globalDefaults.contrast = 100;
-    globalDefaults.static_color_enabled = false;
-    globalDefaults.static_r = 0;
-    globalDefaults.static_g = 0;
-    globalDefaults.static_b = 0;
-    globalDefaults.gradient_enabled = false;
-    globalDefaults.gradient_r2 = 0;
-    globalDefaults.gradient_g2 = 0;
-    globalDefaults.gradient_b2 = 0;
-    globalDefaults.pulse_color_enabled = false;
-    globalDefaults.pulse_r = 0;
-    globalDefaults.pulse_g = 0;
-    globalDefaults.pulse_b = 0;
-    globalDefaults.pulse_speed = 150.0f;
-    globalDefaults.pulse_width = 2.0f;
-    globalDefaults.pulse_fade = 4.0f;
-    globalDefaults.fade_in = 0.0f;
-    globalDefaults.fade_out = 0.0f;
-    LoadStripFromSection(globalDefaults, "global", globalDefaults, iniPathA);
-
-    // Load per-strip settings, falling back to [global] values
-    for (int i = 0; i < 10; i++) {
-        LoadStripFromSection(config.strips[i], StripSectionNames[i], globalDefaults, iniPathA);
-    }
-}
-
-void CheckReload(TransformConfig& config) {
-    config.callCounter++;
-    if (config.callCounter < RELOAD_INTERVAL)
-        return;
-    config.callCounter = 0;
-
-    // Check if file's write time changed
-    HANDLE hFile = CreateFileW(config.iniPath, GENERIC_READ, FILE_SHARE_READ,
-                               nullptr, OPEN_EXISTING, 0, nullptr);
-    if (hFile == INVALID_HANDLE_VALUE) {
-        // File might have been deleted — reset to identity
-        if (config.lastWriteTime.dwHighDateTime != 0 || config.lastWriteTime.dwLowDateTime != 0) {
-            config.lastWriteTime = {};
-            for (int i = 0; i < 10; i++) {
-                config.strips[i].enabled = false;
-                config.strips[i].channelOrder = CH_RGB;
-                config.strips[i].gamma_r = 1.0f;
-                config.strips[i].gamma_g = 1.0f;
-                config.strips[i].gamma_b = 1.0f;
-                config.strips[i].hue_shift = 0;
-                config.strips[i].saturation = 100;
-                config.strips[i].brightness = 100;
-                config.strips[i].contrast = 100;
-                config.strips[i].static_color_enabled = false;
-                config.strips[i].static_r = 0;
-                config.strips[i].static_g = 0;
-                config.strips[i].static_b = 0;
-                config.strips[i].gradient_enabled = false;
-                config.strips[i].gradient_r2 = 0;
-                config.strips[i].gradient_g2 = 0;
-                config.strips[i].gradient_b2 = 0;
-                config.strips[i].pulse_color_enabled = false;
-                config.strips[i].pulse_r = 0;
-                config.strips[i].pulse_g = 0;
-                config.strips[i].pulse_b = 0;
-                config.strips[i].pulse_speed = 150.0f;
-                config.strips[i].pulse_width = 2.0f;
-                config.strips[i].pulse_fade = 4.0f;
-                config.strips[i].fade_in = 0.0f;
-                config.strips[i].fade_out = 0.0f;
-                BuildGammaLUT(config.strips[i].lut_r, 1.0f);
-                BuildGammaLUT(config.strips[i].lut_g, 1.0f);
-                BuildGammaLUT(config.strips[i].lut_b, 1.0f);
-            }
-        }
-        return;
-    }
-
-    FILETIME ft;
-    GetFileTime(hFile, nullptr, nullptr, &ft);
-    CloseHandle(hFile);
-
-    if (CompareFileTime(&ft, &config.lastWriteTime) != 0) {
-        LoadConfig(config);
-    }
-}
-
 // --- RGB <-> HSV conversion (integer-friendly) ---
 
 // Convert RGB (0-255) to HSV where H=0-359, S=0-255, V=0-255
@@ -399,143 +96,603 @@ static void HSVtoRGB(int h, int s, int v, uint8_t& r, uint8_t& g, uint8_t& b) {
     }
 }
 
-void TransformStrip(const StripTransform& strip, uint8_t* data, int numBytes,
-                    const PulseRender& pulse) {
-    if (!strip.enabled && pulse.count == 0)
-        return;
+// --- Per-pixel stages ---
 
-    bool needHSV = (strip.hue_shift != 0 || strip.saturation != 100);
-    bool needContrast = (strip.contrast != 100);
+// Hue shift / saturation / contrast
+static inline void ApplyHSV(const StripTransform& strip, const TransformPlan& plan,
+                            uint8_t& cr, uint8_t& cg, uint8_t& cb) {
+    int h, s, v;
+    RGBtoHSV(cr, cg, cb, h, s, v);
 
-    // Precompute contrast LUT: maps V (0-255) to adjusted V
-    // exponent = 100/contrast, so contrast>100 -> exponent<1 -> brights expand, darks compress
-    uint8_t contrastLUT[256];
-    if (needContrast) {
-        float exponent = 100.0f / static_cast<float>(strip.contrast);
-        for (int j = 0; j < 256; j++) {
-            float normalized = static_cast<float>(j) / 255.0f;
-            float adjusted = powf(normalized, exponent);
-            int val = static_cast<int>(adjusted * 255.0f + 0.5f);
-            contrastLUT[j] = static_cast<uint8_t>(std::min(std::max(val, 0), 255));
-        }
+    if (plan.needContrast)
+        v = plan.contrastLUT[v];
+
+    if (strip.hue_shift != 0)
+        h = (h + strip.hue_shift) % 360;
+
+    if (strip.saturation != 100) {
+        s = (s * strip.saturation) / 100;
+        s = std::min(s, 255);
     }
 
-    // Precompute static/gradient color's H and S if needed
-    int staticH1 = 0, staticS1 = 0, staticV1 = 0;
-    int staticH2 = 0, staticS2 = 0, staticV2 = 0;
-    if (strip.static_color_enabled) {
-        RGBtoHSV(strip.static_r, strip.static_g, strip.static_b, staticH1, staticS1, staticV1);
-        if (strip.gradient_enabled) {
-            RGBtoHSV(strip.gradient_r2, strip.gradient_g2, strip.gradient_b2, staticH2, staticS2, staticV2);
+    HSVtoRGB(h, s, v, cr, cg, cb);
+}
+
+// Replace H and S with the given color, keeping the pixel's (contrast-adjusted) V
+static inline void ApplyStaticColor(const TransformPlan& plan, int h, int s,
+                                    uint8_t& cr, uint8_t& cg, uint8_t& cb) {
+    int v = std::max({ cr, cg, cb });
+
+    if (plan.needContrast)
+        v = plan.contrastLUT[v];
+
+    HSVtoRGB(h, s, v, cr, cg, cb);
+}
+
+// Run the LED-independent pipeline on one pixel (raw game RGB in, transformed RGB out).
+// Reference for the 3D LUT; the plan's stages must produce the same result.
+static void TransformPixel(const StripTransform& strip, const TransformPlan& plan,
+                           uint8_t r, uint8_t g, uint8_t b, uint8_t out[3]) {
+    // swap the channels
+    uint8_t cr, cg, cb;
+    switch (strip.channelOrder) {
+        case CH_RBG: cr = r; cg = b; cb = g; break;
+        case CH_GRB: cr = g; cg = r; cb = b; break;
+        case CH_GBR: cr = g; cg = b; cb = r; break;
+        case CH_BRG: cr = b; cg = r; cb = g; break;
+        case CH_BGR: cr = b; cg = g; cb = r; break;
+        default:     cr = r; cg = g; cb = b; break;
+    }
+
+    cr = strip.lut_r[cr];
+    cg = strip.lut_g[cg];
+    cb = strip.lut_b[cb];
+
+    // Static color OR hue shift/saturation
+    if (strip.static_color_enabled)
+        ApplyStaticColor(plan, plan.staticH, plan.staticS, cr, cg, cb);
+    else if (strip.hue_shift != 0 || strip.saturation != 100 || plan.needContrast)
+        ApplyHSV(strip, plan, cr, cg, cb);
+
+    // brightness scaling
+    if (strip.brightness != 100) {
+        int br = (cr * strip.brightness) / 100;
+        int bg = (cg * strip.brightness) / 100;
+        int bb = (cb * strip.brightness) / 100;
+        cr = static_cast<uint8_t>(std::min(br, 255));
+        cg = static_cast<uint8_t>(std::min(bg, 255));
+        cb = static_cast<uint8_t>(std::min(bb, 255));
+    }
+
+    out[0] = cr;
+    out[1] = cg;
+    out[2] = cb;
+}
+
+// --- 3D LUT (trilinear) ---
+
+static constexpr int LUT3D_STEP = 255 / (LUT3D_SIZE - 1);   // input distance between grid nodes
+
+// Per-input grid cell and 8-bit weight toward the next node, shared by all strips. Computed
+// at compile time, so any thread can read them without setup.
+struct LUT3DAxis {
+    uint8_t cell[256];
+    uint16_t weight[256];
+
+    constexpr LUT3DAxis() : cell(), weight() {
+        for (int x = 0; x < 256; x++) {
+            int c = std::min(x / LUT3D_STEP, LUT3D_SIZE - 2);
+            int rem = x - c * LUT3D_STEP;
+            cell[x] = static_cast<uint8_t>(c);
+            weight[x] = static_cast<uint16_t>((rem * 256 + LUT3D_STEP / 2) / LUT3D_STEP);
         }
     }
+};
 
-    int numLEDs = numBytes / 3;
+static constexpr LUT3DAxis g_lut3dAxis;
+
+// Trilinear lookup of one raw pixel in the plan's 3D LUT
+static inline void SampleLUT3D(const TransformPlan& plan, uint8_t r, uint8_t g, uint8_t b, uint8_t out[3]) {
+    int ir = g_lut3dAxis.cell[r], ig = g_lut3dAxis.cell[g], ib = g_lut3dAxis.cell[b];
+    int wr = g_lut3dAxis.weight[r], wg = g_lut3dAxis.weight[g], wb = g_lut3dAxis.weight[b];
+    const uint8_t* c000 = plan.lut3d[ir][ig][ib];
+    const uint8_t* c001 = plan.lut3d[ir][ig][ib + 1];
+    const uint8_t* c010 = plan.lut3d[ir][ig + 1][ib];
+    const uint8_t* c011 = plan.lut3d[ir][ig + 1][ib + 1];
+    const uint8_t* c100 = plan.lut3d[ir + 1][ig][ib];
+    const uint8_t* c101 = plan.lut3d[ir + 1][ig][ib + 1];
+    const uint8_t* c110 = plan.lut3d[ir + 1][ig + 1][ib];
+    const uint8_t* c111 = plan.lut3d[ir + 1][ig + 1][ib + 1];
+
+    for (int c = 0; c < 3; c++) {
+        // lerp along b (x256), then g (x65536), renormalize, then r
+        int v00 = c000[c] * (256 - wb) + c001[c] * wb;
+        int v01 = c010[c] * (256 - wb) + c011[c] * wb;
+        int v10 = c100[c] * (256 - wb) + c101[c] * wb;
+        int v11 = c110[c] * (256 - wb) + c111[c] * wb;
+        int v0 = (v00 * (256 - wg) + v01 * wg + 128) >> 8;
+        int v1 = (v10 * (256 - wg) + v11 * wg + 128) >> 8;
+        int v = (v0 * (256 - wr) + v1 * wr + 32768) >> 16;
+        out[c] = static_cast<uint8_t>(v);
+    }
+}
 
-    for (int i = 0; i < numBytes; i += 3) {
-        uint8_t r = data[i];
-        uint8_t g = data[i + 1];
-        uint8_t b = data[i + 2];
+// SampleLUT3D of the inputs (r, g, 0-255). The g blend of the nodes along b is done once for
+// the row; nothing is rounded before the b blend, so the results are the same integers.
+static void SampleLUT3DRow(const TransformPlan& plan, uint8_t r, uint8_t g, uint8_t out[256 * 3]) {
+    int ir = g_lut3dAxis.cell[r], ig = g_lut3dAxis.cell[g];
+    int wr = g_lut3dAxis.weight[r], wg = g_lut3dAxis.weight[g];
+    int p0[LUT3D_SIZE][3], p1[LUT3D_SIZE][3];
+    for (int k = 0; k < LUT3D_SIZE; k++) {
+        for (int c = 0; c < 3; c++) {
+            p0[k][c] = plan.lut3d[ir][ig][k][c] * (256 - wg) + plan.lut3d[ir][ig + 1][k][c] * wg;
+            p1[k][c] = plan.lut3d[ir + 1][ig][k][c] * (256 - wg) + plan.lut3d[ir + 1][ig + 1][k][c] * wg;
+        }
+    }
 
-        // swap the channels
-        uint8_t cr, cg, cb;
-        switch (strip.channelOrder) {
-            case CH_RBG: cr = r; cg = b; cb = g; break;
-            case CH_GRB: cr = g; cg = r; cb = b; break;
-            case CH_GBR: cr = g; cg = b; cb = r; break;
-            case CH_BRG: cr = b; cg = r; cb = g; break;
-            case CH_BGR: cr = b; cg = g; cb = r; break;
-            default:     cr = r; cg = g; cb = b; break;
+    for (int b = 0; b < 256; b++) {
+        int ib = g_lut3dAxis.cell[b], wb = g_lut3dAxis.weight[b];
+        for (int c = 0; c < 3; c++) {
+            int v0 = (p0[ib][c] * (256 - wb) + p0[ib + 1][c] * wb + 128) >> 8;
+            int v1 = (p1[ib][c] * (256 - wb) + p1[ib + 1][c] * wb + 128) >> 8;
+            out[b * 3 + c] = static_cast<uint8_t>((v0 * (256 - wr) + v1 * wr + 32768) >> 16);
         }
+    }
+}
 
-        cr = strip.lut_r[cr];
-        cg = strip.lut_g[cg];
-        cb = strip.lut_b[cb];
+// Settings the 3D LUT and its error depend on
+struct LUT3DKey {
+    ChannelOrder channelOrder;
+    int hueShift, saturation, brightness, contrast, budget;
+    bool staticColor;
+    uint8_t staticRGB[3];
+    uint8_t gamma[3][256];
+};
 
-        // Step 3: Static color / gradient OR hue shift/saturation
-        if (strip.static_color_enabled) {
-            int h, s, v;
-            RGBtoHSV(cr, cg, cb, h, s, v);
+static LUT3DKey MakeLUT3DKey(const StripTransform& strip) {
+    LUT3DKey key;
+    memset(&key, 0, sizeof(key));
+    key.channelOrder = strip.channelOrder;
+    key.hueShift = strip.hue_shift;
+    key.saturation = strip.saturation;
+    key.brightness = strip.brightness;
+    key.contrast = strip.contrast;
+    key.budget = strip.lut_max_error;
+    key.staticColor = strip.static_color_enabled;
+    if (key.staticColor) {
+        key.staticRGB[0] = strip.static_r;
+        key.staticRGB[1] = strip.static_g;
+        key.staticRGB[2] = strip.static_b;
+    }
+    memcpy(key.gamma[0], strip.lut_r, 256);
+    memcpy(key.gamma[1], strip.lut_g, 256);
+    memcpy(key.gamma[2], strip.lut_b, 256);
+    return key;
+}
+
+// Results of the last error scans, one per strip's worth: strips often share their color
+// settings through [global], and a reload that changes one strip rescans only that one. The
+// scan is the slow part of a plan build.
+static constexpr int LUT3D_SCAN_CACHE = 10;
+
+struct LUT3DScan {
+    bool valid;
+    LUT3DKey key;
+    int error;
+};
 
-            if (needContrast)
-                v = contrastLUT[v];
-
-            if (strip.gradient_enabled && numLEDs > 1) {
-                // Interpolate H and S between color 1 and color 2 based on LED position
-                int ledIdx = i / 3;
-                // Take shortest path around the hue circle
-                int hDiff = staticH2 - staticH1;
-                if (hDiff > 180) hDiff -= 360;
-                if (hDiff < -180) hDiff += 360;
-                int interpH = (staticH1 + hDiff * ledIdx / (numLEDs - 1) + 360) % 360;
-                int interpS = staticS1 + (staticS2 - staticS1) * ledIdx / (numLEDs - 1);
-                HSVtoRGB(interpH, interpS, v, cr, cg, cb);
-            } else {
-                // Single static color
-                HSVtoRGB(staticH1, staticS1, v, cr, cg, cb);
+static std::mutex g_lut3dScanMutex;
+static LUT3DScan g_lut3dScans[LUT3D_SCAN_CACHE];
+static int g_lut3dScanNext = 0;    // entry the next new result replaces
+
+// Bake the LED-independent pipeline into the plan's 3D LUT, measure its worst-case
+// error against the exact path over every input and enable it only if that stays within
+// lut_max_error. strip.kernel must run the exact path; the scan feeds it 256 inputs at a time
+// and stops at the first row over the budget (about 0.5 s for a strip that passes), so it
+// only runs where lut_max_error opts in, on the config loader thread.
+static void BuildLUT3D(const StripTransform& strip, TransformPlan& plan, const char* section) {
+    for (int r = 0; r < LUT3D_SIZE; r++)
+        for (int g = 0; g < LUT3D_SIZE; g++)
+            for (int b = 0; b < LUT3D_SIZE; b++)
+                TransformPixel(strip, plan,
+                               static_cast<uint8_t>(r * LUT3D_STEP),
+                               static_cast<uint8_t>(g * LUT3D_STEP),
+                               static_cast<uint8_t>(b * LUT3D_STEP),
+                               plan.lut3d[r][g][b]);
+
+    LUT3DKey key = MakeLUT3DKey(strip);
+    std::lock_guard<std::mutex> lock(g_lut3dScanMutex);
+    const LUT3DScan* scan = nullptr;
+    for (const LUT3DScan& entry : g_lut3dScans) {
+        if (entry.valid && memcmp(&key, &entry.key, sizeof(key)) == 0)
+            scan = &entry;
+    }
+    bool cached = (scan != nullptr);
+
+    int maxError = cached ? scan->error : 0;
+    uint8_t exact[256 * 3], approx[256 * 3];
+    for (int r = 0; r < 256 && !cached && maxError <= strip.lut_max_error; r++) {
+        for (int g = 0; g < 256; g++) {
+            for (int b = 0; b < 256; b++) {
+                exact[b * 3] = static_cast<uint8_t>(r);
+                exact[b * 3 + 1] = static_cast<uint8_t>(g);
+                exact[b * 3 + 2] = static_cast<uint8_t>(b);
             }
-        } else if (needHSV || needContrast) {
-            int h, s, v;
+            SampleLUT3DRow(plan, static_cast<uint8_t>(r), static_cast<uint8_t>(g), approx);
+            strip.kernel(strip, exact, sizeof(exact));
+            for (int i = 0; i < 256 * 3; i++)
+                maxError = std::max(maxError, std::abs(exact[i] - approx[i]));
+        }
+    }
+
+    if (!cached) {
+        LUT3DScan& entry = g_lut3dScans[g_lut3dScanNext];
+        g_lut3dScanNext = (g_lut3dScanNext + 1) % LUT3D_SCAN_CACHE;
+        entry.valid = true;
+        entry.key = key;
+        entry.error = maxError;
+    }
+
+    plan.lut3dError = maxError;
+    plan.lut3dEnabled = (maxError <= strip.lut_max_error);
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "sdvxrgb: [%s] 3D LUT max error %s%d (budget %d) -> %s\n", section,
+             plan.lut3dEnabled ? "" : ">= ", maxError, strip.lut_max_error,
+             plan.lut3dEnabled ? "LUT" : "exact path");
+    g_log(msg);
+}
+
+// --- Specialized kernels ---
+// One fused per-pixel loop per combination of channel order, gamma, color mode, contrast
+// and brightness, so nothing inside the loop tests a setting. Pipelines without a color
+// stage keep the SIMD passes instead, which beat a fused scalar loop.
+
+enum ColorMode {
+    COLOR_HSV,
+    COLOR_STATIC,
+    COLOR_GRADIENT
+};
+
+template <ChannelOrder Order>
+static inline void SwizzlePixel(const uint8_t* px, uint8_t& cr, uint8_t& cg, uint8_t& cb) {
+    switch (Order) {
+        case CH_RBG: cr = px[0]; cg = px[2]; cb = px[1]; break;
+        case CH_GRB: cr = px[1]; cg = px[0]; cb = px[2]; break;
+        case CH_GBR: cr = px[1]; cg = px[2]; cb = px[0]; break;
+        case CH_BRG: cr = px[2]; cg = px[0]; cb = px[1]; break;
+        case CH_BGR: cr = px[2]; cg = px[1]; cb = px[0]; break;
+        default:     cr = px[0]; cg = px[1]; cb = px[2]; break;
+    }
+}
+
+// HSVtoRGB with the sextant switch replaced by a component table. s == 0 needs no
+// special case: p, q and t all equal v then.
+static inline void HSVtoRGBSelect(int h, int s, int v, uint8_t& r, uint8_t& g, uint8_t& b) {
+    static const uint8_t Select[6][3] = {
+        { 0, 3, 1 }, { 2, 0, 1 }, { 1, 0, 3 }, { 1, 2, 0 }, { 3, 1, 0 }, { 0, 1, 2 }
+    };
+    int region = h / 60;
+    int remainder = h - region * 60;
+    int c[4];
+    c[0] = v;
+    c[1] = (v * (255 - s)) / 255;
+    c[2] = (v * (255 - (s * remainder) / 60)) / 255;
+    c[3] = (v * (255 - (s * (60 - remainder)) / 60)) / 255;
+    r = static_cast<uint8_t>(c[Select[region][0]]);
+    g = static_cast<uint8_t>(c[Select[region][1]]);
+    b = static_cast<uint8_t>(c[Select[region][2]]);
+}
+
+template <ChannelOrder Order, bool Gamma, ColorMode Mode, bool Contrast, bool Brightness>
+static void ColorKernel(const StripTransform& strip, uint8_t* data, int numBytes) {
+    const TransformPlan& plan = strip.plan;
+    const int hueShift = strip.hue_shift;
+    const int saturation = strip.saturation;
+
+    for (int i = 0, led = 0; i < numBytes; i += 3, led++) {
+        uint8_t cr, cg, cb;
+        SwizzlePixel<Order>(data + i, cr, cg, cb);
+
+        if (Gamma) {
+            cr = plan.channelLUT[0][cr];
+            cg = plan.channelLUT[1][cg];
+            cb = plan.channelLUT[2][cb];
+        }
+
+        int h, s, v;
+        if (Mode == COLOR_HSV) {
+            // Shift 0 and saturation 100 are no-ops here, so apply both unconditionally
             RGBtoHSV(cr, cg, cb, h, s, v);
+            h = (h + hueShift) % 360;
+            s = std::min((s * saturation) / 100, 255);
+        } else if (Mode == COLOR_STATIC) {
+            h = plan.staticH;
+            s = plan.staticS;
+            v = std::max({ cr, cg, cb });
+        } else {
+            int g = std::min(led, plan.numLEDs - 1);
+            h = plan.gradientH[g];
+            s = plan.gradientS[g];
+            v = std::max({ cr, cg, cb });
+        }
+        if (Contrast)
+            v = plan.contrastLUT[v];
+        HSVtoRGBSelect(h, s, v, data[i], data[i + 1], data[i + 2]);
+    }
 
-            if (needContrast)
-                v = contrastLUT[v];
+    if (Brightness)
+        ScaleBrightness(data, numBytes, strip.brightness);
+}
 
-            if (strip.hue_shift != 0)
-                h = (h + strip.hue_shift) % 360;
+// Swizzle / gamma / brightness only: SIMD passes without the stage switch
+template <bool Swizzle, bool Gamma, bool Brightness>
+static void PassKernel(const StripTransform& strip, uint8_t* data, int numBytes) {
+    const TransformPlan& plan = strip.plan;
+    if (Swizzle)
+        SwizzleChannels(strip.channelOrder, data, numBytes);
+    if (Gamma) {
+        for (int i = 0; i < numBytes; i += 3) {
+            data[i] = plan.channelLUT[0][data[i]];
+            data[i + 1] = plan.channelLUT[1][data[i + 1]];
+            data[i + 2] = plan.channelLUT[2][data[i + 2]];
+        }
+    }
+    if (Brightness)
+        ScaleBrightness(data, numBytes, strip.brightness);
+}
 
-            if (strip.saturation != 100) {
-                s = (s * strip.saturation) / 100;
-                s = std::min(s, 255);
-            }
+static void LUT3DKernel(const StripTransform& strip, uint8_t* data, int numBytes) {
+    for (int i = 0; i < numBytes; i += 3)
+        SampleLUT3D(strip.plan, data[i], data[i + 1], data[i + 2], data + i);
+}
+
+// Runtime flags -> instantiation, one template parameter at a time
+template <ChannelOrder Order, bool Gamma, ColorMode Mode, bool Contrast>
+static StripKernelFn PickBrightness(bool brightness) {
+    return brightness ? ColorKernel<Order, Gamma, Mode, Contrast, true>
+                      : ColorKernel<Order, Gamma, Mode, Contrast, false>;
+}
+
+template <ChannelOrder Order, bool Gamma, ColorMode Mode>
+static StripKernelFn PickContrast(bool contrast, bool brightness) {
+    return contrast ? PickBrightness<Order, Gamma, Mode, true>(brightness)
+                    : PickBrightness<Order, Gamma, Mode, false>(brightness);
+}
+
+template <ChannelOrder Order, bool Gamma>
+static StripKernelFn PickMode(ColorMode mode, bool contrast, bool brightness) {
+    switch (mode) {
+        case COLOR_STATIC: return PickContrast<Order, Gamma, COLOR_STATIC>(contrast, brightness);
+        case COLOR_GRADIENT: return PickContrast<Order, Gamma, COLOR_GRADIENT>(contrast, brightness);
+        default: return PickContrast<Order, Gamma, COLOR_HSV>(contrast, brightness);
+    }
+}
+
+template <ChannelOrder Order>
+static StripKernelFn PickGamma(bool gamma, ColorMode mode, bool contrast, bool brightness) {
+    return gamma ? PickMode<Order, true>(mode, contrast, brightness)
+                 : PickMode<Order, false>(mode, contrast, brightness);
+}
+
+static StripKernelFn PickColorKernel(ChannelOrder order, bool gamma, ColorMode mode,
+                                     bool contrast, bool brightness) {
+    switch (order) {
+        case CH_RBG: return PickGamma<CH_RBG>(gamma, mode, contrast, brightness);
+        case CH_GRB: return PickGamma<CH_GRB>(gamma, mode, contrast, brightness);
+        case CH_GBR: return PickGamma<CH_GBR>(gamma, mode, contrast, brightness);
+        case CH_BRG: return PickGamma<CH_BRG>(gamma, mode, contrast, brightness);
+        case CH_BGR: return PickGamma<CH_BGR>(gamma, mode, contrast, brightness);
+        default: return PickGamma<CH_RGB>(gamma, mode, contrast, brightness);
+    }
+}
+
+static StripKernelFn PickPassKernel(bool swizzle, bool gamma, bool brightness) {
+    static const StripKernelFn Kernels[2][2][2] = {
+        { { PassKernel<false, false, false>, PassKernel<false, false, true> },
+          { PassKernel<false, true, false>, PassKernel<false, true, true> } },
+        { { PassKernel<true, false, false>, PassKernel<true, false, true> },
+          { PassKernel<true, true, false>, PassKernel<true, true, true> } },
+    };
+    return Kernels[swizzle][gamma][brightness];
+}
 
-            HSVtoRGB(h, s, v, cr, cg, cb);
+// Choose the kernel matching a compiled plan's stage list
+static StripKernelFn SelectKernel(const StripTransform& strip) {
+    const TransformPlan& plan = strip.plan;
+    bool swizzle = false, gamma = false, brightness = false, hasColor = false;
+    ColorMode mode = COLOR_HSV;
+
+    for (int st = 0; st < plan.stageCount; st++) {
+        switch (plan.stages[st]) {
+            case STAGE_LUT3D: return LUT3DKernel;
+            case STAGE_SWIZZLE: swizzle = true; break;
+            case STAGE_CHANNEL_LUT: gamma = true; break;
+            case STAGE_HSV: hasColor = true; mode = COLOR_HSV; break;
+            case STAGE_STATIC: hasColor = true; mode = COLOR_STATIC; break;
+            case STAGE_GRADIENT: hasColor = true; mode = COLOR_GRADIENT; break;
+            case STAGE_BRIGHTNESS: brightness = true; break;
         }
+    }
+
+    if (!hasColor)
+        return PickPassKernel(swizzle, gamma, brightness);
+    return PickColorKernel(strip.channelOrder, gamma, mode, plan.needContrast, brightness);
+}
+
+// --- Transform plan ---
+
+void BuildPlan(StripTransform& strip, int numLEDs, const char* section) {
+    TransformPlan& plan = strip.plan;
+    plan.generation = g_planGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+    plan.stageCount = 0;
+    plan.lut3dEnabled = false;
+    plan.lut3dError = 0;
+    plan.numLEDs = 0;
+    plan.pulse.entries = 0;
+    BuildGammaLUT(strip.lut_r, strip.gamma_r);
+    BuildGammaLUT(strip.lut_g, strip.gamma_g);
+    BuildGammaLUT(strip.lut_b, strip.gamma_b);
+    strip.kernel = PickPassKernel(false, false, false);
+    BuildFadePlan(plan.fade, strip.fade_in, strip.fade_out, strip.fade_curve);
+    if (!strip.enabled)
+        return;
 
-        // brightness scaling
-        if (strip.brightness != 100) {
-            int br = (cr * strip.brightness) / 100;
-            int bg = (cg * strip.brightness) / 100;
-            int bb = (cb * strip.brightness) / 100;
-            cr = static_cast<uint8_t>(std::min(br, 255));
-            cg = static_cast<uint8_t>(std::min(bg, 255));
-            cb = static_cast<uint8_t>(std::min(bb, 255));
+    if (strip.pulse_color_enabled)
+        BuildPulseTable(plan.pulse, strip.pulse_width, strip.pulse_fade,
+                        strip.pulse_r, strip.pulse_g, strip.pulse_b);
+
+    // Contrast LUT
+    // exponent = 100/contrast, so contrast>100 -> exponent<1 -> brights expand, darks compress
+    plan.needContrast = (strip.contrast != 100);
+    if (plan.needContrast) {
+        float exponent = 100.0f / static_cast<float>(strip.contrast);
+        for (int j = 0; j < 256; j++) {
+            float normalized = static_cast<float>(j) / 255.0f;
+            float adjusted = powf(normalized, exponent);
+            int val = static_cast<int>(adjusted * 255.0f + 0.5f);
+            plan.contrastLUT[j] = static_cast<uint8_t>(std::min(std::max(val, 0), 255));
         }
+    }
 
-        data[i] = cr;
-        data[i + 1] = cg;
-        data[i + 2] = cb;
+    // Static color's H and S, and the per-LED gradient through the stops
+    int v = 0;
+    plan.staticH = plan.staticS = 0;
+    bool gradient = false;
+    if (strip.static_color_enabled) {
+        RGBtoHSV(strip.static_r, strip.static_g, strip.static_b, plan.staticH, plan.staticS, v);
+        gradient = strip.gradient_enabled && numLEDs > 1;
     }
+    if (gradient) {
+        // Stops along the strip, starting with the static color at LED 0
+        int count = strip.gradient_count + 1;
+        int stopLED[MAX_GRADIENT_STOPS + 1], stopH[MAX_GRADIENT_STOPS + 1], stopS[MAX_GRADIENT_STOPS + 1];
+        stopLED[0] = 0;
+        stopH[0] = plan.staticH;
+        stopS[0] = plan.staticS;
+        for (int j = 1; j < count; j++) {
+            const uint8_t* rgb = strip.gradient_rgb[j - 1];
+            RGBtoHSV(rgb[0], rgb[1], rgb[2], stopH[j], stopS[j], v);
+            stopLED[j] = static_cast<int>(strip.gradient_pos[j - 1] * (numLEDs - 1) + 0.5f);
+        }
 
-    // Pulse rendering pass — solid center + cosine fade edges, additive blend
-    if (pulse.count > 0) {
-        int numLEDsForPulse = numBytes / 3;
-        float totalHalf = pulse.width + pulse.fade; // total half-span
-
-        for (int p = 0; p < pulse.count; p++) {
-            float pos = pulse.positions[p];
-            int minLED = std::max(0, static_cast<int>(pos - totalHalf));
-            int maxLED = std::min(numLEDsForPulse - 1, static_cast<int>(pos + totalHalf));
-
-            for (int led = minLED; led <= maxLED; led++) {
-                float dist = fabsf(static_cast<float>(led) - pos);
-                float blend;
-                if (dist <= pulse.width) {
-                    // Solid center
-                    blend = 1.0f;
-                } else if (dist < totalHalf) {
-                    // Cosine fade zone
-                    float t = (dist - pulse.width) / pulse.fade;
-                    blend = 0.5f * (1.0f + cosf(t * 3.14159265f));
-                } else {
-                    continue;
-                }
+        plan.numLEDs = numLEDs;
+        int k = 0;
+        for (int i = 0; i < numLEDs; i++) {
+            while (k < count - 1 && stopLED[k + 1] <= i)
+                k++;
+            if (k == count - 1) {
+                // Past the last stop: hold its color
+                plan.gradientH[i] = static_cast<uint16_t>(stopH[k]);
+                plan.gradientS[i] = static_cast<uint8_t>(stopS[k]);
+                continue;
+            }
+
+            // Interpolate H and S between stop k and k+1, taking the shortest path around the hue circle
+            int span = stopLED[k + 1] - stopLED[k];
+            int offset = i - stopLED[k];
+            int hDiff = stopH[k + 1] - stopH[k];
+            if (hDiff > 180) hDiff -= 360;
+            if (hDiff < -180) hDiff += 360;
+            plan.gradientH[i] = static_cast<uint16_t>((stopH[k] + hDiff * offset / span + 360) % 360);
+            plan.gradientS[i] = static_cast<uint8_t>(stopS[k] + (stopS[k + 1] - stopS[k]) * offset / span);
+        }
+    }
 
-                int idx = led * 3;
-                data[idx]     = static_cast<uint8_t>(std::min(255, data[idx]     + static_cast<int>(pulse.r * blend)));
-                data[idx + 1] = static_cast<uint8_t>(std::min(255, data[idx + 1] + static_cast<int>(pulse.g * blend)));
-                data[idx + 2] = static_cast<uint8_t>(std::min(255, data[idx + 2] + static_cast<int>(pulse.b * blend)));
+    bool colorStage = strip.static_color_enabled || strip.hue_shift != 0 ||
+                      strip.saturation != 100 || plan.needContrast;
+
+    if (strip.channelOrder != CH_RGB)
+        plan.stages[plan.stageCount++] = STAGE_SWIZZLE;
+
+    // Gamma LUTs; with nothing between gamma and brightness, brightness is folded in
+    bool foldBrightness = !colorStage && strip.brightness != 100;
+    if (strip.gamma_r != 1.0f || strip.gamma_g != 1.0f || strip.gamma_b != 1.0f) {
+        const uint8_t* gammaLUT[3] = { strip.lut_r, strip.lut_g, strip.lut_b };
+        for (int c = 0; c < 3; c++) {
+            for (int j = 0; j < 256; j++) {
+                int val = gammaLUT[c][j];
+                if (foldBrightness)
+                    val = std::min((val * strip.brightness) / 100, 255);
+                plan.channelLUT[c][j] = static_cast<uint8_t>(val);
             }
         }
+        plan.stages[plan.stageCount++] = STAGE_CHANNEL_LUT;
+    } else {
+        foldBrightness = false;
+    }
+
+    if (strip.static_color_enabled)
+        plan.stages[plan.stageCount++] = gradient ? STAGE_GRADIENT : STAGE_STATIC;
+    else if (colorStage)
+        plan.stages[plan.stageCount++] = STAGE_HSV;
+
+    if (strip.brightness != 100 && !foldBrightness)
+        plan.stages[plan.stageCount++] = STAGE_BRIGHTNESS;
+
+    strip.kernel = SelectKernel(strip);
+
+    // An LED-independent color stage can be replaced by the 3D LUT, checked against the
+    // exact kernel just selected
+    if (colorStage && !gradient && strip.lut_max_error > 0) {
+        BuildLUT3D(strip, plan, section);
+        if (plan.lut3dEnabled) {
+            plan.stageCount = 0;
+            plan.stages[plan.stageCount++] = STAGE_LUT3D;
+            strip.kernel = SelectKernel(strip);
+        }
     }
 }
+
+void RunPlan(const StripTransform& strip, uint8_t* data, int numBytes) {
+    const TransformPlan& plan = strip.plan;
+
+    for (int st = 0; st < plan.stageCount; st++) {
+        switch (plan.stages[st]) {
+            case STAGE_SWIZZLE:
+                SwizzleChannels(strip.channelOrder, data, numBytes);
+                break;
+            case STAGE_CHANNEL_LUT:
+                for (int i = 0; i < numBytes; i += 3) {
+                    data[i] = plan.channelLUT[0][data[i]];
+                    data[i + 1] = plan.channelLUT[1][data[i + 1]];
+                    data[i + 2] = plan.channelLUT[2][data[i + 2]];
+                }
+                break;
+            case STAGE_LUT3D:
+                for (int i = 0; i < numBytes; i += 3)
+                    SampleLUT3D(plan, data[i], data[i + 1], data[i + 2], data + i);
+                break;
+            case STAGE_HSV:
+                for (int i = 0; i < numBytes; i += 3)
+                    ApplyHSV(strip, plan, data[i], data[i + 1], data[i + 2]);
+                break;
+            case STAGE_STATIC:
+                for (int i = 0; i < numBytes; i += 3)
+                    ApplyStaticColor(plan, plan.staticH, plan.staticS, data[i], data[i + 1], data[i + 2]);
+                break;
+            case STAGE_GRADIENT:
+                // The table covers the strip's own LED count; extra LEDs keep the end color
+                for (int i = 0, led = 0; i < numBytes; i += 3, led++) {
+                    int g = std::min(led, plan.numLEDs - 1);
+                    ApplyStaticColor(plan, plan.gradientH[g], plan.gradientS[g], data[i], data[i + 1], data[i + 2]);
+                }
+                break;
+            case STAGE_BRIGHTNESS:
+                ScaleBrightness(data, numBytes, strip.brightness);
+                break;
+        }
+    }
+}
+
+void TransformStrip(const StripTransform& strip, uint8_t* data, int numBytes,
+                    const PulseRing* pulses) {
+    if (!strip.enabled)
+        return;
+
+    strip.kernel(strip, data, numBytes);
+
+    // Pulse rendering pass — table lookup per covered LED, additive blend
+    if (pulses && pulses->count > 0)
+        RenderPulses(strip.plan.pulse, *pulses, data, numBytes);
+}
@@ -1,7 +1,7 @@
 #pragma once
-#define NOMINMAX
-#include <Windows.h>
 #include <cstdint>
+#include "pulse.h"
+#include "fade.h"
 
 enum ChannelOrder {
     CH_RGB = 0,
@@ -12,6 +12,52 @@ enum ChannelOrder {
     CH_BGR
 };
 
+// 3D LUT grid size per axis. 18 nodes puts a node on every multiple of 15 (0, 15, ... 255),
+// so grid points are exact inputs of the full pipeline.
+static constexpr int LUT3D_SIZE = 18;
+
+static constexpr int MAX_STRIP_LEDS = 94;  // largest strip: ctrl_panel
+static_assert(MAX_STRIP_LEDS * 3 <= FADE_MAX_BYTES, "fade state too small for the largest strip");
+
+static constexpr int MAX_GRADIENT_STOPS = 8;  // gradient colors after static_color
+
+// Pipeline stages a TransformPlan can run, in execution order
+enum TransformStage : uint8_t {
+    STAGE_SWIZZLE,              // channel reorder (SIMD)
+    STAGE_CHANNEL_LUT,          // per-channel gamma LUT (brightness folded in when no color stage follows)
+    STAGE_LUT3D,                // whole color pipeline through the 3D LUT
+    STAGE_HSV,                  // hue shift / saturation / contrast
+    STAGE_STATIC,               // single static color, contrast on V
+    STAGE_GRADIENT,             // per-LED gradient color, contrast on V
+    STAGE_BRIGHTNESS            // brightness scaling (SIMD)
+};
+
+static constexpr int MAX_PLAN_STAGES = 4;
+
+// Everything TransformStrip needs, derived once from a StripTransform at config load
+struct TransformPlan {
+    uint32_t generation;                    // new on every BuildPlan, so output caches see a rebuild
+    int stageCount;                         // number of active stages (0 = identity)
+    TransformStage stages[MAX_PLAN_STAGES];
+    uint8_t channelLUT[3][256];             // gamma (+ brightness) per output channel
+    bool needContrast;
+    uint8_t contrastLUT[256];               // maps V (0-255) to adjusted V
+    int staticH, staticS;                   // static color H (0-359) and S (0-255)
+    int numLEDs;                            // LED count the gradient table was built for
+    uint16_t gradientH[MAX_STRIP_LEDS];     // per-LED gradient H
+    uint8_t gradientS[MAX_STRIP_LEDS];      // per-LED gradient S
+    bool lut3dEnabled;                      // true = STAGE_LUT3D replaces the whole pipeline
+    int lut3dError;                         // measured max channel error of the 3D LUT vs the exact path
+    uint8_t lut3d[LUT3D_SIZE][LUT3D_SIZE][LUT3D_SIZE][3]; // [r][g][b] of raw input -> output RGB
+    PulseTable pulse;                       // pulse color * falloff by distance from the center
+    FadePlan fade;                          // fade speeds per direction for the strip's curve
+};
+
+struct StripTransform;
+
+// Runs a strip's compiled plan over packed RGB data in-place
+typedef void (*StripKernelFn)(const StripTransform& strip, uint8_t* data, int numBytes);
+
 struct StripTransform {
     bool enabled;               // false = skip transform (all identity)
     ChannelOrder channelOrder;
@@ -22,49 +68,40 @@ struct StripTransform {
     int contrast;               // 0-200 percent (100 = no change, >100 = stronger pulse)
     bool static_color_enabled;  // true = override color (keeps brightness)
     uint8_t static_r, static_g, static_b;  // static color
-    bool gradient_enabled;      // true = gradient between two colors (keeps brightness)
-    uint8_t gradient_r2, gradient_g2, gradient_b2;  // gradient end color
+    bool gradient_enabled;      // true = gradient from static color through the stops (keeps brightness)
+    int gradient_count;         // number of stops after the static color
+    uint8_t gradient_rgb[MAX_GRADIENT_STOPS][3];  // stop colors
+    float gradient_pos[MAX_GRADIENT_STOPS];       // stop positions 0-1 along the strip (static color is at 0)
     bool pulse_color_enabled;   // true = traveling pulse on beat
     uint8_t pulse_r, pulse_g, pulse_b;  // pulse color
     float pulse_speed;          // LEDs per second
     float pulse_width;          // half-width of solid center in LEDs
     float pulse_fade;           // fade length beyond solid center in LEDs
+    int pulse_capacity;         // max simultaneous pulses (oldest is dropped beyond it)
     float fade_in;              // fade-in duration in ms (0 = instant)
     float fade_out;             // fade-out duration in ms (0 = instant)
+    FadeCurve fade_curve;       // shape of both fades
+    float onset_weight;         // weight of this strip's brightness in the frame's onset signal
+    float onset_sensitivity;    // onset strength (deviations above the mean rise) that fires a pulse
     uint8_t lut_r[256];        // precomputed gamma LUT
     uint8_t lut_g[256];
     uint8_t lut_b[256];
+    int lut_max_error;          // max channel error allowed for the 3D LUT (0 = never use it)
+    TransformPlan plan;         // compiled pipeline, rebuilt whenever the settings above change
+    StripKernelFn kernel;       // instantiation specialized for the plan's stages
 };
 
-static constexpr int MAX_PULSES = 8;
-
-struct PulseRender {
-    int count;                  // number of active pulses (0 = none)
-    float positions[MAX_PULSES]; // LED index (fractional) per pulse
-    float width;                // half-width of solid center (shared)
-    float fade;                 // fade length beyond solid center (shared)
-    uint8_t r, g, b;           // pulse color (shared)
-};
-
-struct TransformConfig {
-    StripTransform strips[10];
-    wchar_t iniPath[MAX_PATH];
-    FILETIME lastWriteTime;
-    int callCounter;
-};
-
-// Strip section names in the INI file, indexed 0-9
-extern const char* StripSectionNames[10];
-
-// Initialize config with identity defaults and resolve INI path
-void InitConfig(TransformConfig& config, HMODULE hModule);
+// Receives diagnostic messages such as the 3D LUT error report (default: stderr)
+typedef void (*TransformLogFn)(const char* message);
+void SetTransformLog(TransformLogFn fn);
 
-// Load or reload config from INI file
-void LoadConfig(TransformConfig& config);
+// Compile a strip's settings into its TransformPlan (LoadStrips does this for every strip;
+// call it after changing settings in code). numLEDs sizes the gradient table.
+void BuildPlan(StripTransform& strip, int numLEDs, const char* section);
 
-// Check if INI file changed and reload if so (call every hook invocation)
-void CheckReload(TransformConfig& config);
+// Execute a strip's plan stage by stage (generic path; TransformStrip uses strip.kernel)
+void RunPlan(const StripTransform& strip, uint8_t* data, int numBytes);
 
-// Apply transformation to a strip's RGB data in-place
+// Apply transformation to a strip's RGB data in-place, then add its active pulses (if any)
 void TransformStrip(const StripTransform& strip, uint8_t* data, int numBytes,
-                    const PulseRender& pulse = {});
+                    const PulseRing* pulses = nullptr);
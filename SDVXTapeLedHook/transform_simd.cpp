@@ -0,0 +1,348 @@
+#include "transform_simd.h"
+#include "simd_target.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef SDVX_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Source channel (0=R, 1=G, 2=B) for each output channel, indexed by ChannelOrder
+static const uint8_t SwizzleSource[6][3] = {
+    { 0, 1, 2 },    // CH_RGB
+    { 0, 2, 1 },    // CH_RBG
+    { 1, 0, 2 },    // CH_GRB
+    { 1, 2, 0 },    // CH_GBR
+    { 2, 0, 1 },    // CH_BRG
+    { 2, 1, 0 },    // CH_BGR
+};
+
+// --- Scalar kernels ---
+
+static void SwizzleScalar(ChannelOrder order, uint8_t* data, int numBytes) {
+    const uint8_t* src = SwizzleSource[order];
+    for (int i = 0; i + 2 < numBytes; i += 3) {
+        uint8_t px[3] = { data[i], data[i + 1], data[i + 2] };
+        data[i] = px[src[0]];
+        data[i + 1] = px[src[1]];
+        data[i + 2] = px[src[2]];
+    }
+}
+
+static void ScaleBrightnessScalar(uint8_t* data, int numBytes, int brightness) {
+    for (int i = 0; i < numBytes; i++)
+        data[i] = static_cast<uint8_t>(std::min((data[i] * brightness) / 100, 255));
+}
+
+static uint32_t SumBytesScalar(const uint8_t* data, int numBytes) {
+    uint32_t sum = 0;
+    for (int i = 0; i < numBytes; i++)
+        sum += data[i];
+    return sum;
+}
+
+#ifdef SDVX_X86
+
+// pshufb mask that swizzles the first 4 pixels (12 bytes) of a 16-byte block
+static void BuildSwizzleMask(ChannelOrder order, uint8_t mask[16]) {
+    for (int p = 0; p < 4; p++)
+        for (int c = 0; c < 3; c++)
+            mask[p * 3 + c] = static_cast<uint8_t>(p * 3 + SwizzleSource[order][c]);
+    for (int i = 12; i < 16; i++)
+        mask[i] = static_cast<uint8_t>(i);
+}
+
+// The swizzle kernels load 16/32 bytes but only store the whole pixels they hold
+// (12/24 bytes). Writing back the pass-through bytes as well would make every
+// following load overlap the previous store and stall store-to-load forwarding.
+
+// --- SSE4.1 kernels ---
+
+SDVX_TARGET_SSE41
+static inline void SwizzleBlockSSE41(uint8_t* p, __m128i mask) {
+    __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), mask);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), v);
+    uint32_t last = static_cast<uint32_t>(_mm_extract_epi32(v, 2));
+    memcpy(p + 8, &last, 4);
+}
+
+SDVX_TARGET_SSE41
+static void SwizzleSSE41(ChannelOrder order, uint8_t* data, int numBytes) {
+    alignas(16) uint8_t maskBytes[16];
+    BuildSwizzleMask(order, maskBytes);
+    __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(maskBytes));
+
+    // 4 pixels per iteration
+    int i = 0;
+    for (; i + 16 <= numBytes; i += 12)
+        SwizzleBlockSSE41(data + i, mask);
+    SwizzleScalar(order, data + i, numBytes - i);
+}
+
+// (x * brightness) / 100 on 8 u16 lanes: x * brightness <= 51000, and
+// n / 100 == (n >> 2) / 25 == mulhi(n >> 2, 5243) >> 1 for that range
+SDVX_TARGET_SSE41
+static inline __m128i ScaleLanesSSE41(__m128i x16, __m128i factor) {
+    __m128i n = _mm_mullo_epi16(x16, factor);
+    return _mm_srli_epi16(_mm_mulhi_epu16(_mm_srli_epi16(n, 2), _mm_set1_epi16(5243)), 1);
+}
+
+// 16 bytes, packus saturates to 255
+SDVX_TARGET_SSE41
+static inline void ScaleBlockSSE41(uint8_t* p, __m128i factor) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i lo = ScaleLanesSSE41(_mm_cvtepu8_epi16(v), factor);
+    __m128i hi = ScaleLanesSSE41(_mm_unpackhi_epi8(v, _mm_setzero_si128()), factor);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(lo, hi));
+}
+
+SDVX_TARGET_SSE41
+static void ScaleBrightnessSSE41(uint8_t* data, int numBytes, int brightness) {
+    __m128i factor = _mm_set1_epi16(static_cast<short>(brightness));
+    int i = 0;
+    for (; i + 16 <= numBytes; i += 16)
+        ScaleBlockSSE41(data + i, factor);
+    ScaleBrightnessScalar(data + i, numBytes - i, brightness);
+}
+
+// Loaded at offset n, keeps the last n bytes of a 16-byte block
+alignas(16) static const uint8_t TailMask[32] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// The last numBytes - i (< 16) bytes: one block ending at numBytes, minus the bytes before i.
+// Strips are at least 16 bytes, so the block never starts before data.
+SDVX_TARGET_SSE41
+static inline __m128i SumTailSSE41(const uint8_t* data, int i, int numBytes) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + numBytes - 16));
+    __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(TailMask + (numBytes - i)));
+    return _mm_sad_epu8(_mm_and_si128(v, mask), _mm_setzero_si128());
+}
+
+// psadbw against zero sums each 8-byte half into a 64-bit lane
+SDVX_TARGET_SSE41
+static uint32_t SumBytesSSE41(const uint8_t* data, int numBytes) {
+    if (numBytes < 16)
+        return SumBytesScalar(data, numBytes);
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= numBytes; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+    if (i < numBytes)
+        acc = _mm_add_epi64(acc, SumTailSSE41(data, i, numBytes));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(acc) + _mm_extract_epi32(acc, 2));
+}
+
+// --- AVX2 kernels ---
+// Tails use 128-bit ops compiled inside the AVX2 functions (VEX-encoded), so no
+// legacy-SSE code runs with dirty upper YMM state.
+
+SDVX_TARGET_AVX2
+static void SwizzleAVX2(ChannelOrder order, uint8_t* data, int numBytes) {
+    alignas(16) uint8_t maskBytes[16];
+    BuildSwizzleMask(order, maskBytes);
+    __m128i mask128 = _mm_load_si128(reinterpret_cast<const __m128i*>(maskBytes));
+    __m256i mask = _mm256_broadcastsi128_si256(mask128);
+
+    // Spread dwords 0-3 / 3-6 over the two lanes so each lane starts on a pixel
+    __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    __m256i gather = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+    // 8 pixels per iteration
+    int i = 0;
+    for (; i + 32 <= numBytes; i += 24) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        v = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v, spread), mask);
+        v = _mm256_permutevar8x32_epi32(v, gather);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm256_castsi256_si128(v));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(data + i + 16), _mm256_extracti128_si256(v, 1));
+    }
+    for (; i + 16 <= numBytes; i += 12) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), mask128);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(data + i), v);
+        uint32_t last = static_cast<uint32_t>(_mm_extract_epi32(v, 2));
+        memcpy(data + i + 8, &last, 4);
+    }
+    _mm256_zeroupper();
+    SwizzleScalar(order, data + i, numBytes - i);
+}
+
+SDVX_TARGET_AVX2
+static inline __m256i ScaleLanesAVX2(__m256i x16, __m256i factor) {
+    __m256i n = _mm256_mullo_epi16(x16, factor);
+    return _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_srli_epi16(n, 2), _mm256_set1_epi16(5243)), 1);
+}
+
+SDVX_TARGET_AVX2
+static void ScaleBrightnessAVX2(uint8_t* data, int numBytes, int brightness) {
+    __m256i factor = _mm256_set1_epi16(static_cast<short>(brightness));
+
+    // 32 bytes per iteration; packus works per 128-bit lane, so restore qword order after it
+    int i = 0;
+    for (; i + 32 <= numBytes; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i lo = ScaleLanesAVX2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)), factor);
+        __m256i hi = ScaleLanesAVX2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)), factor);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), packed);
+    }
+    if (i + 16 <= numBytes) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m256i scaled = ScaleLanesAVX2(_mm256_cvtepu8_epi16(v), factor);
+        __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(scaled), _mm256_extracti128_si256(scaled, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), packed);
+        i += 16;
+    }
+    _mm256_zeroupper();
+    ScaleBrightnessScalar(data + i, numBytes - i, brightness);
+}
+
+SDVX_TARGET_AVX2
+static uint32_t SumBytesAVX2(const uint8_t* data, int numBytes) {
+    if (numBytes < 16)
+        return SumBytesScalar(data, numBytes);
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= numBytes; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+    }
+    __m128i acc128 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    if (i + 16 <= numBytes) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        acc128 = _mm_add_epi64(acc128, _mm_sad_epu8(v, _mm_setzero_si128()));
+        i += 16;
+    }
+    if (i < numBytes) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + numBytes - 16));
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(TailMask + (numBytes - i)));
+        acc128 = _mm_add_epi64(acc128, _mm_sad_epu8(_mm_and_si128(v, mask), _mm_setzero_si128()));
+    }
+    _mm256_zeroupper();
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(acc128) + _mm_extract_epi32(acc128, 2));
+}
+
+// --- CPU detection ---
+
+static void CpuId(int leaf, int subleaf, int regs[4]) {
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    unsigned int a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    regs[0] = static_cast<int>(a);
+    regs[1] = static_cast<int>(b);
+    regs[2] = static_cast<int>(c);
+    regs[3] = static_cast<int>(d);
+#endif
+}
+
+static uint64_t ReadXCR0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+#endif // SDVX_X86
+
+SimdLevel DetectSimdLevel() {
+#ifdef SDVX_X86
+    int regs[4];
+    CpuId(0, 0, regs);
+    int maxLeaf = regs[0];
+
+    CpuId(1, 0, regs);
+    bool ssse3 = (regs[2] & (1 << 9)) != 0;
+    bool sse41 = (regs[2] & (1 << 19)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!ssse3 || !sse41)
+        return SIMD_SCALAR;
+
+    // AVX2 also needs the OS to save YMM state (XCR0 bits 1 and 2)
+    if (maxLeaf >= 7 && osxsave && avx && (ReadXCR0() & 0x6) == 0x6) {
+        CpuId(7, 0, regs);
+        if (regs[1] & (1 << 5))
+            return SIMD_AVX2;
+    }
+    return SIMD_SSE41;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+typedef void (*SwizzleFn)(ChannelOrder order, uint8_t* data, int numBytes);
+typedef void (*ScaleBrightnessFn)(uint8_t* data, int numBytes, int brightness);
+typedef uint32_t (*SumBytesFn)(const uint8_t* data, int numBytes);
+
+static SimdLevel g_simdLevel = SIMD_SCALAR;
+static SwizzleFn g_swizzle = SwizzleScalar;
+static ScaleBrightnessFn g_scaleBrightness = ScaleBrightnessScalar;
+static SumBytesFn g_sumBytes = SumBytesScalar;
+
+void SetSimdLevel(SimdLevel level) {
+    level = std::min(level, DetectSimdLevel());
+    g_simdLevel = level;
+    switch (level) {
+#ifdef SDVX_X86
+        case SIMD_AVX2:
+            g_swizzle = SwizzleAVX2;
+            g_scaleBrightness = ScaleBrightnessAVX2;
+            g_sumBytes = SumBytesAVX2;
+            break;
+        case SIMD_SSE41:
+            g_swizzle = SwizzleSSE41;
+            g_scaleBrightness = ScaleBrightnessSSE41;
+            g_sumBytes = SumBytesSSE41;
+            break;
+#endif
+        default:
+            g_swizzle = SwizzleScalar;
+            g_scaleBrightness = ScaleBrightnessScalar;
+            g_sumBytes = SumBytesScalar;
+            break;
+    }
+}
+
+void InitSimd() {
+    SetSimdLevel(DetectSimdLevel());
+}
+
+SimdLevel GetSimdLevel() {
+    return g_simdLevel;
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_SSE41: return "SSE4.1";
+        case SIMD_AVX2: return "AVX2";
+        default: return "scalar";
+    }
+}
+
+void SwizzleChannels(ChannelOrder order, uint8_t* data, int numBytes) {
+    if (order == CH_RGB)
+        return;
+    g_swizzle(order, data, numBytes);
+}
+
+void ScaleBrightness(uint8_t* data, int numBytes, int brightness) {
+    if (brightness == 100)
+        return;
+    g_scaleBrightness(data, numBytes, brightness);
+}
+
+uint32_t SumBytes(const uint8_t* data, int numBytes) {
+    return g_sumBytes(data, numBytes);
+}
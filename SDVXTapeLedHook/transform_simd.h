@@ -0,0 +1,30 @@
+#pragma once
+#include "transform.h"
+
+// Instruction set used by the vectorized strip kernels
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE41,
+    SIMD_AVX2
+};
+
+// Detect the best supported level via CPUID and select its kernels (call once at startup)
+void InitSimd();
+
+// Highest level this CPU (and OS) supports
+SimdLevel DetectSimdLevel();
+
+// Currently selected level; SetSimdLevel clamps to what the CPU supports (for benchmarks)
+SimdLevel GetSimdLevel();
+void SetSimdLevel(SimdLevel level);
+
+const char* SimdLevelName(SimdLevel level);
+
+// Reorder the channels of packed RGB data in-place (CH_RGB is a no-op)
+void SwizzleChannels(ChannelOrder order, uint8_t* data, int numBytes);
+
+// Scale every byte by brightness/100 in-place, saturating at 255
+void ScaleBrightness(uint8_t* data, int numBytes, int brightness);
+
+// Sum of numBytes bytes
+uint32_t SumBytes(const uint8_t* data, int numBytes);
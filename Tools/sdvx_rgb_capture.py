@@ -11,11 +11,12 @@ Usage:
 
 import argparse
 import colorsys
-import mmap
 import struct
 import sys
 import time
 
+from sdvx_shm import EVENT_SLOT_CAPTURE, ShmReader
+
 DATA_SIZE = 1284
 LED_COUNTS = [74, 12, 12, 56, 56, 94, 12, 12, 14, 86]
 LED_OFFSETS = [0, 74, 86, 98, 154, 210, 304, 316, 328, 342]
@@ -38,8 +39,9 @@ FRAME_SIZE = 8 + DATA_SIZE
 
 def record(output_path):
     """Record LED data from shared memory to a binary file."""
+    reader = ShmReader(EVENT_SLOT_CAPTURE)
     try:
-        shm = mmap.mmap(-1, DATA_SIZE, "sdvxrgb")
+        reader.open()
     except Exception as e:
         print(f"Failed to open shared memory 'sdvxrgb': {e}")
         print("Make sure the game is running with the hook loaded.")
@@ -47,34 +49,43 @@ def record(output_path):
 
     last_data = None
     frame_count = 0
+    qpc_origin = None  # (qpc ticks, wall time) of the first v2 frame
 
     print(f"Recording to {output_path} ... Press Ctrl+C to stop.")
 
     try:
         with open(output_path, "wb") as f:
             while True:
-                shm.seek(0)
-                data = shm.read(DATA_SIZE)
-
-                # Skip duplicate frames
-                if data == last_data:
-                    time.sleep(1.0 / 60.0)
-                    continue
-
-                last_data = data
-                timestamp = time.time()
-                f.write(struct.pack("d", timestamp))
-                f.write(data)
+                # Woken by the hook's frame-ready event on v2, a fixed 1/60 s poll on legacy
+                reader.wait(1.0 / 60.0)
+
+                if reader.version == 2:
+                    # Every frame since the last wakeup, stamped with the hook's publish time
+                    frames = []
+                    for _, qpc_time, data in reader.read_ring():
+                        if qpc_origin is None:
+                            qpc_origin = (qpc_time, time.time())
+                        timestamp = qpc_origin[1] + (qpc_time - qpc_origin[0]) / reader.qpc_frequency
+                        frames.append((timestamp, data))
+                else:
+                    # Legacy: only the current frame, duplicates skipped by content
+                    _, data = reader.read()
+                    if data == last_data:
+                        continue
+                    last_data = data
+                    frames = [(time.time(), data)]
+
+                for timestamp, data in frames:
+                    f.write(struct.pack("d", timestamp))
+                    f.write(data)
+                    frame_count += 1
+                    if frame_count % 60 == 0:
+                        print(f"  {frame_count} frames captured", end="\r")
                 f.flush()
-                frame_count += 1
-
-                if frame_count % 60 == 0:
-                    print(f"  {frame_count} frames captured", end="\r")
-
-                time.sleep(1.0 / 60.0)
 
     except KeyboardInterrupt:
-        print(f"\nStopped. {frame_count} frames saved to {output_path}")
+        lost = f", {reader.lost} lost (fell behind the ring)" if reader.lost else ""
+        print(f"\nStopped. {frame_count} frames saved to {output_path}{lost}")
 
 
 def read_capture(path):
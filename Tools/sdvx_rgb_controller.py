@@ -9,12 +9,13 @@ Usage:
 """
 
 import colorsys
-import mmap
 import os
 import sys
 import tkinter as tk
 from tkinter import colorchooser
 
+from sdvx_shm import ShmReader
+
 DATA_SIZE = 1284
 LED_COUNTS = [74, 12, 12, 56, 56, 94, 12, 12, 14, 86]
 LED_OFFSETS = [0, 74, 86, 98, 154, 210, 304, 316, 328, 342]
@@ -291,8 +292,10 @@ class SDVXController:
 
         # Try opening shared memory
         try:
-            self.shm = mmap.mmap(-1, DATA_SIZE, "sdvxrgb")
+            self.shm = ShmReader()
+            self.shm.open()
         except Exception:
+            self.shm = None
             self.status_var.set("Shared memory not available (game not running?)")
 
         # Start preview update loop
@@ -322,8 +325,9 @@ class SDVXController:
         """Read shared memory and update strip color previews."""
         if self.shm:
             try:
-                self.shm.seek(0)
-                data = self.shm.read(DATA_SIZE)
+                _, data = self.shm.read()
+                if data is None:
+                    raise ValueError("no consistent frame")
 
                 for i in range(10):
                     offset = LED_OFFSETS[i] * 3
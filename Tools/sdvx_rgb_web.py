@@ -45,12 +45,16 @@ STRIP_KEYS = [
     "contrast",
     "fade_in",
     "fade_out",
+    "fade_curve",
     "static_color",
     "gradient_color",
     "pulse_color",
     "pulse_speed",
     "pulse_width",
     "pulse_fade",
+    "pulse_capacity",
+    "onset_weight",
+    "onset_sensitivity",
 ]
 
 INI_PATH = ""
@@ -61,6 +65,10 @@ FRONTEND_PATH = os.path.join(
 )
 
 
+# Sections the frontend does not edit; kept as they are on every save
+PRESERVED_SECTIONS = ("hook",)
+
+
 def read_ini():
     """Read sdvxrgb.ini and return a dict of sections."""
     config = configparser.ConfigParser()
@@ -76,6 +84,12 @@ def read_ini():
 
 def write_ini(data):
     """Write a dict of sections to sdvxrgb.ini."""
+    # Keep the sections the editor does not manage (e.g. [hook])
+    data = dict(data)
+    for section, values in read_ini().items():
+        if section in PRESERVED_SECTIONS and section not in data:
+            data[section] = values
+
     lines = []
     for section, values in data.items():
         # Only write sections that have at least one non-empty value
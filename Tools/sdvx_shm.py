@@ -0,0 +1,166 @@
+"""
+Shared-memory reader for the SDVX RGB hook.
+
+Prefers the "sdvxrgb_v2" mapping (see SDVXTapeLedHook/shm_protocol.h): a header with a
+seqlock, frame number and timestamp in front of the 1284-byte frame, so reads are never torn
+and a new frame can be told from one already read. Falls back to the legacy "sdvxrgb"
+mapping (the bare frame) when the hook does not publish v2.
+
+With v2 the hook also signals a frame-ready event per consumer slot, so wait() blocks until
+the next frame instead of sleeping a fixed interval, and read_ring() returns every frame
+published since the last call (up to the ring's 128 frames) for readers that must not lose any.
+"""
+
+import mmap
+import struct
+import sys
+import time
+
+DATA_SIZE = 1284
+
+LEGACY_NAME = "sdvxrgb"
+V2_NAME = "sdvxrgb_v2"
+V2_MAGIC = 0x58564453  # "SDVX"
+V2_VERSION = 2
+V2_MAP_SIZE = 181760  # sizeof(ShmFrameV2)
+
+# Frame-ready event slots (SHM_EVENT_NAMES); one waiter per slot
+EVENT_SLOT_SENDER = 0
+EVENT_SLOT_CAPTURE = 1
+EVENT_NAME = "sdvxrgb_v2_frame{}"
+_SYNCHRONIZE = 0x00100000
+
+# ShmHeaderV2 field offsets
+_STATIC = struct.Struct("<IHHIHH")  # magic, version, headerSize, totalSize, stripCount, frameBytes
+_QPC_FREQUENCY = struct.Struct("<q")  # at 56
+_RING = struct.Struct("<III")  # ringOffset, ringSlotSize, ringSlots at 64
+_SEQUENCE = struct.Struct("<I")  # at 128
+_FRAME = struct.Struct("<IQq")  # dirtyMask, frameNumber, qpcTime at 132
+_U64 = struct.Struct("<Q")  # ringHead at 152, ShmRingSlot.frameNumber at 0
+_SLOT = struct.Struct("<QIIq")  # ShmRingSlot: frameNumber, dirtyMask, reserved, qpcTime
+_QPC_FREQUENCY_OFFSET = 56
+_RING_OFFSET = 64
+_SEQUENCE_OFFSET = 128
+_FRAME_OFFSET = 132
+_RING_HEAD_OFFSET = 152
+_SLOT_RGB_OFFSET = 64
+
+
+class ShmReader:
+    """Reads frames from whichever mapping the hook provides.
+
+    event_slot: frame-ready event to wait on (None = wait() just sleeps)."""
+
+    def __init__(self, event_slot=None):
+        self.shm = None
+        self.version = 0
+        self.header_size = 0
+        self.qpc_frequency = 0
+        self.ring_offset = 0
+        self.ring_slot_size = 0
+        self.ring_slots = 0
+        self.next_frame = None  # read_ring cursor
+        self.lost = 0  # frames overwritten before read_ring got to them
+        self.event_slot = event_slot
+        self.event = None
+
+    def open(self):
+        """Open the mapping, v2 first. Raises OSError if neither can be opened."""
+        self.close()
+        # mmap creates an empty mapping when the name does not exist yet: a zero magic
+        try:
+            shm = mmap.mmap(-1, V2_MAP_SIZE, V2_NAME)
+            magic, version, header_size = _STATIC.unpack_from(shm, 0)[:3]
+            if magic == V2_MAGIC and version == V2_VERSION:
+                self.shm = shm
+                self.version = 2
+                self.header_size = header_size
+                self.qpc_frequency = _QPC_FREQUENCY.unpack_from(shm, _QPC_FREQUENCY_OFFSET)[0]
+                self.ring_offset, self.ring_slot_size, self.ring_slots = _RING.unpack_from(shm, _RING_OFFSET)
+                self.next_frame = _U64.unpack_from(shm, _RING_HEAD_OFFSET)[0] + 1
+                self._open_event()
+                return
+            shm.close()
+        except (OSError, ValueError):
+            pass
+
+        self.shm = mmap.mmap(-1, DATA_SIZE, LEGACY_NAME)
+        self.version = 1
+
+    def _open_event(self):
+        if self.event_slot is None or sys.platform != "win32":
+            return
+        import ctypes
+
+        kernel32 = ctypes.WinDLL("kernel32", use_last_error=True)
+        kernel32.OpenEventW.restype = ctypes.c_void_p
+        kernel32.WaitForSingleObject.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+        kernel32.CloseHandle.argtypes = [ctypes.c_void_p]
+        handle = kernel32.OpenEventW(_SYNCHRONIZE, False, EVENT_NAME.format(self.event_slot))
+        self.event = (kernel32, handle) if handle else None
+
+    def close(self):
+        if self.event:
+            kernel32, handle = self.event
+            kernel32.CloseHandle(handle)
+        if self.shm:
+            self.shm.close()
+        self.shm = None
+        self.event = None
+        self.version = 0
+
+    def wait(self, timeout):
+        """Block until the hook signals a new frame or timeout seconds pass. Without the
+        event (legacy mapping, other platforms) this just sleeps for timeout."""
+        if not self.event:
+            time.sleep(timeout)
+            return
+        kernel32, handle = self.event
+        kernel32.WaitForSingleObject(handle, int(timeout * 1000))
+
+    def read(self, attempts=64):
+        """Return (frame_number, data). frame_number is None on the legacy mapping;
+        (None, None) if no consistent v2 frame could be read."""
+        if self.version != 2:
+            return None, self.shm[0:DATA_SIZE]
+
+        shm = self.shm
+        for _ in range(attempts):
+            before = _SEQUENCE.unpack_from(shm, _SEQUENCE_OFFSET)[0]
+            if before & 1:
+                continue
+            data = shm[self.header_size:self.header_size + DATA_SIZE]
+            frame_number = _FRAME.unpack_from(shm, _FRAME_OFFSET)[1]
+            if _SEQUENCE.unpack_from(shm, _SEQUENCE_OFFSET)[0] == before:
+                return frame_number, data
+        return None, None
+
+    def read_ring(self, attempts=64):
+        """Return [(frame_number, qpc_time, data), ...] for every frame published since the
+        last call, oldest first. Frames already overwritten are skipped and added to self.lost.
+        Needs the v2 mapping."""
+        shm = self.shm
+        frames = []
+        retries = 0
+        while retries < attempts:
+            head = _U64.unpack_from(shm, _RING_HEAD_OFFSET)[0]
+            if self.next_frame > head:
+                break
+
+            oldest = max(head - self.ring_slots + 1, 1)
+            if self.next_frame < oldest:
+                self.lost += oldest - self.next_frame
+                self.next_frame = oldest
+
+            slot = self.ring_offset + (self.next_frame & (self.ring_slots - 1)) * self.ring_slot_size
+            if _U64.unpack_from(shm, slot)[0] != self.next_frame:
+                retries += 1  # being overwritten: the head has moved past it
+                continue
+            data = shm[slot + _SLOT_RGB_OFFSET:slot + _SLOT_RGB_OFFSET + DATA_SIZE]
+            frame_number, _, _, qpc_time = _SLOT.unpack_from(shm, slot)
+            if frame_number == self.next_frame:
+                frames.append((frame_number, qpc_time, data))
+                self.next_frame += 1
+            else:
+                retries += 1
+        return frames
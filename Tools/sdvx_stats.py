@@ -0,0 +1,273 @@
+"""
+SDVX RGB hook latency monitor
+
+Reads the hook's "sdvxrgb_stats" mapping (see SDVXTapeLedHook/stats_protocol.h) and prints
+live p50/p99/max of every stage it times, from the change in its histograms over each
+interval. Instrumentation is switched on while the monitor runs and restored on exit.
+
+Usage:
+    python sdvx_stats.py [--interval SEC] [--per-strip]   - Print live latencies
+    python sdvx_stats.py --enable | --disable              - Switch instrumentation and exit
+"""
+
+import argparse
+import mmap
+import struct
+import sys
+import time
+
+STATS_NAME = "sdvxrgb_stats"
+STATS_MAGIC = 0x54534453  # "SDST"
+STATS_VERSION = 1
+STATS_MAP_SIZE = 31296  # sizeof(StatsBlock)
+
+STRIP_NAMES = [
+    "title",
+    "upper_left_speaker",
+    "upper_right_speaker",
+    "left_wing",
+    "right_wing",
+    "ctrl_panel",
+    "lower_left_speaker",
+    "lower_right_speaker",
+    "woofer",
+    "v_unit",
+]
+STRIP_STAGES = ["hook", "beat", "transform", "fade", "original"]
+FRAME_STAGES = ["config", "publish", "pass"]
+
+# StatsBlock header
+_HEADER = struct.Struct("<IHHIHHHHIIIIxxxxq")
+_ENABLED = struct.Struct("<I")  # at 64
+_U64 = struct.Struct("<Q")  # frames at 72, StatsStrip.calls at 0 and cacheHits at 8
+_ENABLED_OFFSET = 64
+_FRAMES_OFFSET = 72
+_STRIP_STAGES_OFFSET = 64  # StatsStrip.stages
+
+# StatsHistogram: count, sumTicks, maxTicks, reserved, then the buckets at 32
+_HISTOGRAM = struct.Struct("<QQQQ")
+_BUCKETS_OFFSET = 32
+
+
+def bucket_low(bucket):
+    """Smallest sample in a bucket (StatsBucketLow)."""
+    if bucket < 4:
+        return bucket
+    return (4 + (bucket & 3)) << (bucket // 4 - 1)
+
+
+class Histogram:
+    def __init__(self, count, total, peak, buckets):
+        self.count = count
+        self.total = total
+        self.peak = peak  # exact maximum since the hook started
+        self.buckets = buckets
+
+    def __sub__(self, other):
+        return Histogram(
+            self.count - other.count,
+            self.total - other.total,
+            self.peak,
+            [a - b for a, b in zip(self.buckets, other.buckets)],
+        )
+
+    def __add__(self, other):
+        return Histogram(
+            self.count + other.count,
+            self.total + other.total,
+            max(self.peak, other.peak),
+            [a + b for a, b in zip(self.buckets, other.buckets)],
+        )
+
+    def percentile(self, p):
+        """Upper bound in ticks of the p-quantile (StatsPercentile), None when empty."""
+        total = sum(self.buckets)
+        if total == 0:
+            return None
+        rank = max(int(p * total + 0.5), 1)
+        seen = 0
+        for i, n in enumerate(self.buckets):
+            seen += n
+            if seen >= rank:
+                return bucket_low(i + 1) - 1
+        return None
+
+    def top(self):
+        """Upper bound in ticks of the largest sample, None when empty."""
+        for i in range(len(self.buckets) - 1, -1, -1):
+            if self.buckets[i]:
+                return bucket_low(i + 1) - 1
+        return None
+
+
+class StatsReader:
+    def __init__(self):
+        self.shm = None
+
+    def open(self):
+        """Open the mapping. Returns False until the hook has initialized it."""
+        self.close()
+        # mmap creates an empty mapping when the name does not exist yet: a zero magic
+        shm = mmap.mmap(-1, STATS_MAP_SIZE, STATS_NAME)
+        fields = _HEADER.unpack_from(shm, 0)
+        if fields[0] != STATS_MAGIC or fields[1] != STATS_VERSION:
+            shm.close()
+            return False
+        (_, _, self.buckets, _, self.strip_count, self.strip_stages, self.frame_stages, _,
+         self.histogram_size, self.frame_offset, self.strip_offset, self.strip_size, _) = fields
+        self.shm = shm
+        return True
+
+    def close(self):
+        if self.shm:
+            self.shm.close()
+        self.shm = None
+
+    @property
+    def enabled(self):
+        return _ENABLED.unpack_from(self.shm, _ENABLED_OFFSET)[0] != 0
+
+    @enabled.setter
+    def enabled(self, value):
+        _ENABLED.pack_into(self.shm, _ENABLED_OFFSET, 1 if value else 0)
+
+    def ticks_per_second(self):
+        return _HEADER.unpack_from(self.shm, 0)[-1]
+
+    def _histogram(self, offset):
+        count, total, peak, _ = _HISTOGRAM.unpack_from(self.shm, offset)
+        buckets = list(struct.unpack_from(f"<{self.buckets}I", self.shm, offset + _BUCKETS_OFFSET))
+        return Histogram(count, total, peak, buckets)
+
+    def snapshot(self):
+        """{"frames": n, "calls": [per strip], "hits": [per strip], "frame": [per stage],
+        "strips": [[per stage]]}"""
+        frame = [
+            self._histogram(self.frame_offset + s * self.histogram_size)
+            for s in range(self.frame_stages)
+        ]
+        calls = []
+        hits = []
+        strips = []
+        for i in range(self.strip_count):
+            base = self.strip_offset + i * self.strip_size
+            calls.append(_U64.unpack_from(self.shm, base)[0])
+            hits.append(_U64.unpack_from(self.shm, base + 8)[0])
+            strips.append([
+                self._histogram(base + _STRIP_STAGES_OFFSET + s * self.histogram_size)
+                for s in range(self.strip_stages)
+            ])
+        return {
+            "frames": _U64.unpack_from(self.shm, _FRAMES_OFFSET)[0],
+            "calls": calls,
+            "hits": hits,
+            "frame": frame,
+            "strips": strips,
+        }
+
+
+def format_us(ticks, ticks_per_second):
+    if ticks is None:
+        return f"{'-':>10}"
+    return f"{ticks * 1e6 / ticks_per_second:10.2f}"
+
+
+def print_row(name, h, seconds, ticks_per_second):
+    mean = h.total / h.count if h.count else None
+    print(
+        f"  {name:<24}{h.count / seconds:10.1f}"
+        f"{format_us(mean, ticks_per_second)}"
+        f"{format_us(h.percentile(0.50), ticks_per_second)}"
+        f"{format_us(h.percentile(0.99), ticks_per_second)}"
+        f"{format_us(h.top(), ticks_per_second)}"
+        f"{format_us(h.peak if h.peak else None, ticks_per_second)}"
+    )
+
+
+def print_interval(before, after, seconds, ticks_per_second, per_strip):
+    print(f"\n{'stage':<26}{'rate/s':>10}{'mean':>10}{'p50':>10}{'p99':>10}{'max':>10}{'peak':>10}   (us)")
+    print("frame")
+    for s, name in enumerate(FRAME_STAGES):
+        print_row(name, after["frame"][s] - before["frame"][s], seconds, ticks_per_second)
+
+    if per_strip:
+        for i, strip in enumerate(after["strips"]):
+            print(STRIP_NAMES[i] if i < len(STRIP_NAMES) else f"strip {i}")
+            for s, name in enumerate(STRIP_STAGES):
+                print_row(name, strip[s] - before["strips"][i][s], seconds, ticks_per_second)
+    else:
+        print("all strips")
+        for s, name in enumerate(STRIP_STAGES):
+            merged = None
+            for i, strip in enumerate(after["strips"]):
+                delta = strip[s] - before["strips"][i][s]
+                merged = delta if merged is None else merged + delta
+            print_row(name, merged, seconds, ticks_per_second)
+
+    rates = [
+        f"{STRIP_NAMES[i] if i < len(STRIP_NAMES) else i} {(a - b) / seconds:.0f}"
+        for i, (a, b) in enumerate(zip(after["calls"], before["calls"]))
+    ]
+    print("calls/s: " + ", ".join(rates))
+
+    # Strips not served from the cache ran the stages, beat detection first
+    hits = sum(after["hits"]) - sum(before["hits"])
+    misses = sum(strip[1].count - before["strips"][i][1].count for i, strip in enumerate(after["strips"]))
+    if hits + misses:
+        print(f"unchanged-input cache: {100.0 * hits / (hits + misses):.1f}% of strips skipped the stages")
+    print("p50/p99/max are bucket bounds over the interval; peak is the exact maximum so far")
+
+
+def monitor(reader, interval, per_strip):
+    was_enabled = reader.enabled
+    reader.enabled = True
+    try:
+        before = reader.snapshot()
+        start = time.monotonic()
+        while True:
+            time.sleep(interval)
+            after = reader.snapshot()
+            now = time.monotonic()
+            ticks_per_second = reader.ticks_per_second()
+            if ticks_per_second <= 0:
+                print("waiting for frames to calibrate the stats clock...")
+            elif after["frames"] == before["frames"] and after["calls"] == before["calls"]:
+                print("no frames from the hook")
+            else:
+                print_interval(before, after, now - start, ticks_per_second, per_strip)
+            before, start = after, now
+    except KeyboardInterrupt:
+        pass
+    finally:
+        reader.enabled = was_enabled
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="SDVX RGB hook latency monitor - live p50/p99/max of the hook's stages"
+    )
+    parser.add_argument("--interval", type=float, default=1.0, help="Seconds between reports")
+    parser.add_argument("--per-strip", action="store_true", help="Report every strip separately")
+    parser.add_argument("--enable", action="store_true", help="Switch instrumentation on and exit")
+    parser.add_argument("--disable", action="store_true", help="Switch instrumentation off and exit")
+    args = parser.parse_args()
+
+    reader = StatsReader()
+    try:
+        if not reader.open():
+            print("The hook is not running (no sdvxrgb_stats mapping)", file=sys.stderr)
+            sys.exit(1)
+    except (OSError, ValueError) as e:
+        print(f"Cannot open sdvxrgb_stats: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    if args.enable or args.disable:
+        reader.enabled = args.enable
+        print(f"Instrumentation {'enabled' if args.enable else 'disabled'}")
+    else:
+        monitor(reader, max(args.interval, 0.1), args.per_strip)
+    reader.close()
+
+
+if __name__ == "__main__":
+    main()
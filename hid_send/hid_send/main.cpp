@@ -1,44 +1,117 @@
 #include <windows.h>
 #include <iostream>
-#include <ctime>
 #include <stdlib.h>
 #include "hidapi.h"
+#include "../../SDVXTapeLedHook/shm_protocol.h"
+#include "../../RGB_receiver/device_stats.h"
 #pragma comment(lib,"hidapi.lib")
 using namespace std;
 
-// shared memory
+// shared memory (v2 when the hook provides it, legacy bare frame otherwise)
 static TCHAR szName[] = TEXT("sdvxrgb");
 HANDLE hMapFile;
 LPSTR pBuf;
+const ShmFrameV2* pShmV2; // non-null when pBuf is the v2 mapping
+HANDLE hFrameEvent; // v2 frame-ready event, waited on instead of polling
 const int DATA_SIZE = 1284;
+uint8_t lightData[DATA_SIZE];
+
+// resend an unchanged frame after this long so the device does not time out (it blanks after 500ms)
+const DWORD KEEPALIVE_MS = 100;
+// with no new frame for this long, remap the v2 memory to notice the game has exited
+const DWORD STALE_MS = 2000;
+// the legacy mapping has no frame event: poll it this often
+const DWORD LEGACY_POLL_MS = 2;
+uint64_t lastFrameNumber;
+DWORD lastFrameTime;
+DWORD lastSendTime;
 
 // hid variables
 hid_device* handle;
 const int vid = 0x1234; // vendor id
 const int pid = 0x1234; // product id
 
+// device status (RGB_receiver/device_stats.h), read every STATS_MS
+const DWORD STATS_MS = 5000;
+DWORD lastStatsTime;
+bool deviceStats; // cleared when the firmware has no status report
+device_stats lastStats;
+
 // program variables
 int openFailedCounter;
 
 static void Delay(int time)
 {
-	clock_t now = clock();
-	while (clock() - now < time);
+	Sleep(time);
 }
 
 static int openSharedMemory()
 {
+	// prefer v2: consistent frames and a frame number to skip unchanged ones
+	pShmV2 = NULL;
+	hMapFile = OpenFileMappingA(FILE_MAP_READ, FALSE, SHM_V2_NAME);
+	if (hMapFile != NULL)
+	{
+		pBuf = (LPSTR)MapViewOfFile(hMapFile, FILE_MAP_READ, 0, 0, sizeof(ShmFrameV2));
+		if (pBuf != NULL)
+		{
+			pShmV2 = (const ShmFrameV2*)pBuf;
+			hFrameEvent = OpenEventA(SYNCHRONIZE, FALSE, SHM_EVENT_NAMES[SHM_EVENT_SLOT_SENDER]);
+			// a restarted game numbers its frames from 1 again, none of them has been sent yet
+			lastFrameNumber = 0;
+			lastFrameTime = GetTickCount();
+			return 1;
+		}
+		CloseHandle(hMapFile);
+	}
+
 	hMapFile = OpenFileMapping(FILE_MAP_READ, FALSE, szName);
 	if (hMapFile == NULL) return 0;
 	pBuf = (LPSTR)MapViewOfFile(hMapFile, FILE_MAP_READ, 0, 0, DATA_SIZE);
-	if (pBuf == NULL) return 0;
+	if (pBuf == NULL)
+	{
+		CloseHandle(hMapFile);
+		return 0;
+	}
 	return 1;
 }
 
 static void closeSharedMemory()
 {
-	UnmapViewOfFile(pBuf);
-	CloseHandle(hMapFile);
+	if (pBuf) UnmapViewOfFile(pBuf);
+	if (hMapFile) CloseHandle(hMapFile);
+	if (hFrameEvent) CloseHandle(hFrameEvent);
+	pBuf = NULL;
+	hMapFile = NULL;
+	hFrameEvent = NULL;
+	pShmV2 = NULL;
+}
+
+static void printDeviceStats()
+{
+	uint8_t buf[65]{};
+	if (hid_get_input_report(handle, buf, sizeof(buf)) < (int)sizeof(device_stats) + 1 || buf[1] < 1)
+	{
+		deviceStats = false; // older firmware stalls the request
+		return;
+	}
+	device_stats stats;
+	memcpy(&stats, buf + 1, sizeof(stats));
+	uint32_t frames = stats.frames - lastStats.frames;
+	uint32_t received = stats.received - lastStats.received;
+	if (lastStats.version && frames)
+	{
+		printf("Device: %u frames, %s%s output on %u state machines, CPU busy %.0f us/frame (max %u us)\n", frames,
+			(stats.flags & DEVICE_STATS_PARALLEL) ? "parallel" : stats.outputs > 1 ? "multi-SM" : "serial",
+			(stats.flags & DEVICE_STATS_DMA) ? " DMA" : "", stats.outputs,
+			(double)(stats.busy_sum_us - lastStats.busy_sum_us) / frames, stats.busy_max_us);
+		if (stats.version >= 2 && received)
+		{
+			printf("Device: USB receive to first pixel %.0f us (max %u us)\n",
+				(double)(stats.latency_sum_us - lastStats.latency_sum_us) / received, stats.latency_max_us);
+		}
+	}
+	lastStats = stats;
 }
 
 static void closeHID()
@@ -70,10 +143,13 @@ beginning:
 		goto beginning;
 	}
 
+	deviceStats = true;
+	lastStats = {};
 	Delay(1000);
 	while (1)
 	{
-		if (openSharedMemory())
+		// the v2 mapping stays open between frames, the legacy one is remapped every frame
+		if (pBuf || openSharedMemory())
 		{
 			// reset
 			if (openFailedCounter)
@@ -84,8 +160,44 @@ beginning:
 			openFailedCounter = 0;
 
 			// copy data
-			uint8_t lightData[DATA_SIZE]{};
-			memcpy(lightData, pBuf, DATA_SIZE);
+			if (pShmV2)
+			{
+				// block until the hook publishes a frame, at most until the next keepalive
+				if (hFrameEvent) WaitForSingleObject(hFrameEvent, KEEPALIVE_MS);
+				else Sleep(1);
+
+				uint8_t frame[DATA_SIZE];
+				ShmFrameInfo info;
+				DWORD now = GetTickCount();
+				if (ReadShmV2(pShmV2, frame, info) && info.frameNumber != lastFrameNumber)
+				{
+					memcpy(lightData, frame, DATA_SIZE);
+					lastFrameNumber = info.frameNumber;
+					lastFrameTime = now;
+				}
+				else if (now - lastFrameTime >= STALE_MS)
+				{
+					// the game may have exited, remap to find out
+					closeSharedMemory();
+					continue;
+				}
+				else if (now - lastSendTime < KEEPALIVE_MS)
+				{
+					continue;
+				}
+			}
+			else
+			{
+				// wait between polls instead of spinning, and send only changed frames and keepalives
+				Sleep(LEGACY_POLL_MS);
+				if (memcmp(lightData, pBuf, DATA_SIZE) == 0 && GetTickCount() - lastSendTime < KEEPALIVE_MS)
+				{
+					closeSharedMemory();
+					continue;
+				}
+				memcpy(lightData, pBuf, DATA_SIZE);
+			}
+			lastSendTime = GetTickCount();
 
 			// send data to the device
 			uint8_t buf[65]{};
@@ -104,6 +216,12 @@ beginning:
 					goto beginning;
 				}
 			}
+
+			if (deviceStats && lastSendTime - lastStatsTime >= STATS_MS)
+			{
+				lastStatsTime = lastSendTime;
+				printDeviceStats();
+			}
 		}
 		else
 		{
@@ -119,7 +237,7 @@ beginning:
 			openFailedCounter++;
 			Delay(1000);
 		}
-		closeSharedMemory();
+		if (!pShmV2) closeSharedMemory();
 	}
 	return 0;
 }
\ No newline at end of file